@@ -0,0 +1,199 @@
+/*****************************************************************//**
+ * \file   atlas.cpp
+ * \brief  Every sprite in one texture, drawn in batches
+ *********************************************************************/
+
+#include "atlas.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+#include <SDL2/SDL_image.h>
+
+namespace
+{
+    // by Sprite, without the set's suffix
+    constexpr const char* SPRITE_NAMES[] = {
+        "square brown dark",
+        "square brown light",
+        "selected",
+        "vision",
+        "b_pawn", "b_rook", "b_knight", "b_bishop", "b_king", "b_queen",
+        "w_pawn", "w_rook", "w_knight", "w_bishop", "w_king", "w_queen"
+    };
+
+    static_assert(sizeof(SPRITE_NAMES) / sizeof(SPRITE_NAMES[0]) == SPRITE_NB, "one file per sprite");
+
+    // smallest first
+    constexpr SpriteSet SPRITE_SETS[] = {
+        { "128px/", "_png_shadow_128px.png", 128 },
+        { "256px/", "_png_shadow_256px.png", 256 },
+        { "1x/", "_1x.png", 451 },
+        { "512px/", "_png_shadow_512px.png", 512 },
+        { "2x/", "_2x.png", 901 },
+        { "1024px/", "_png_shadow_1024px.png", 1024 }
+    };
+
+    std::string spritePath(const std::string& directory, const SpriteSet& set, Sprite sprite)
+    {
+        // the overlays are this game's own and only come in one size
+        if (sprite == Sprite::SELECTED || sprite == Sprite::VISION)
+            return directory + "2x/" + SPRITE_NAMES[static_cast<int>(sprite)] + ".png";
+
+        return directory + set.directory + SPRITE_NAMES[static_cast<int>(sprite)] + set.suffix;
+    }
+
+    // decodes the image and scales it into its cell of the sheet
+    void loadSprite(const std::string& path, SDL_Surface* sheet, const SDL_Rect& cell)
+    {
+        SDL_Surface* loaded = IMG_Load(path.c_str());
+        if (!loaded)
+        {
+            SDL_Log("Failed to load image: %s", IMG_GetError());
+            return;
+        }
+
+        // the stretch needs both surfaces in the same format, it is filtered
+        // once here and not every frame
+        SDL_Surface* image = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+        if (!image)
+            return;
+
+        SDL_Rect dest = cell;
+        SDL_SoftStretchLinear(image, nullptr, sheet, &dest);
+        SDL_FreeSurface(image);
+    }
+}
+
+
+const SpriteSet& chooseSpriteSet(int cellSize)
+{
+    for (const auto& set : SPRITE_SETS)
+        if (set.size >= cellSize)
+            return set;
+
+    return SPRITE_SETS[std::size(SPRITE_SETS) - 1];
+}
+
+
+SDL_Surface* SpriteAtlas::Compose(const std::string& directory, int cellSize, int threads)
+{
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, Atlas::SheetWidth(cellSize), Atlas::SheetHeight(cellSize), 32, SDL_PIXELFORMAT_RGBA32);
+    if (!sheet)
+    {
+        SDL_Log("Failed to create the sprite atlas: %s", SDL_GetError());
+        return nullptr;
+    }
+
+    // a thread takes the next sprite until there are none left, the cells do
+    // not overlap so they all write to the sheet without a lock
+    const SpriteSet& set = chooseSpriteSet(cellSize);
+    std::atomic<int> next{ 0 };
+    auto work = [&]() {
+        for (int i; (i = next.fetch_add(1, std::memory_order_relaxed)) < SPRITE_NB;)
+        {
+            auto sprite = static_cast<Sprite>(i);
+            loadSprite(spritePath(directory, set, sprite), sheet, Atlas::GetRect(sprite, cellSize));
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < std::min(threads, SPRITE_NB); i++)
+        helpers.emplace_back(work);
+    work();
+    for (auto& helper : helpers)
+        helper.join();
+
+    return sheet;
+}
+
+
+bool SpriteAtlas::Load(SDL_Renderer* renderer, const std::string& directory, int cellSize, int threads)
+{
+    SDL_Surface* sheet = Compose(directory, cellSize, threads);
+    if (!sheet)
+        return false;
+
+    bool loaded = Load(renderer, sheet->pixels, sheet->pitch, cellSize);
+    SDL_FreeSurface(sheet);
+    return loaded;
+}
+
+
+bool SpriteAtlas::Load(SDL_Renderer* renderer, const void* pixels, int pitch, int _cellSize)
+{
+    Destroy();
+
+    cellSize = _cellSize;
+    width = Atlas::SheetWidth(cellSize);
+    height = Atlas::SheetHeight(cellSize);
+
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, width, height);
+    if (!texture || SDL_UpdateTexture(texture, nullptr, pixels, pitch) != 0)
+    {
+        SDL_Log("Failed to create the sprite atlas: %s", SDL_GetError());
+        Destroy();
+        return false;
+    }
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+
+void SpriteAtlas::Destroy()
+{
+    if (texture)
+        SDL_DestroyTexture(texture);
+    texture = nullptr;
+}
+
+
+void SpriteBatch::Draw(SDL_Renderer* renderer, SDL_Texture* texture, int width, int height, bool batched)
+{
+    if (!batched)
+    {
+        for (const auto& quad : quads)
+        {
+            SDL_SetTextureColorMod(texture, quad.color.r, quad.color.g, quad.color.b);
+            SDL_SetTextureAlphaMod(texture, quad.color.a);
+            SDL_RenderCopy(renderer, texture, &quad.source, &quad.dest);
+        }
+        SDL_SetTextureColorMod(texture, 255, 255, 255);
+        SDL_SetTextureAlphaMod(texture, 255);
+        return;
+    }
+
+    vertices.clear();
+    indices.clear();
+
+    for (const auto& quad : quads)
+    {
+        // a scaled quad has its texture coordinates half a texel inside the
+        // source, so its edges never sample the neighbours, one drawn 1:1 maps
+        // texel to pixel
+        const SDL_Rect& source = quad.source;
+        float inset = source.w != quad.dest.w || source.h != quad.dest.h ? 0.5f : 0.0f;
+        float u0 = (source.x + inset) / width, u1 = (source.x + source.w - inset) / width;
+        float v0 = (source.y + inset) / height, v1 = (source.y + source.h - inset) / height;
+
+        float x0 = static_cast<float>(quad.dest.x), x1 = static_cast<float>(quad.dest.x + quad.dest.w);
+        float y0 = static_cast<float>(quad.dest.y), y1 = static_cast<float>(quad.dest.y + quad.dest.h);
+
+        int first = static_cast<int>(vertices.size());
+        vertices.push_back({ { x0, y0 }, quad.color, { u0, v0 } });
+        vertices.push_back({ { x1, y0 }, quad.color, { u1, v0 } });
+        vertices.push_back({ { x1, y1 }, quad.color, { u1, v1 } });
+        vertices.push_back({ { x0, y1 }, quad.color, { u0, v1 } });
+
+        for (int corner : { 0, 1, 2, 0, 2, 3 })
+            indices.push_back(first + corner);
+    }
+
+    if (!indices.empty())
+        SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+            indices.data(), static_cast<int>(indices.size()));
+}
@@ -0,0 +1,214 @@
+/*****************************************************************//**
+ * \file   atlas.hpp
+ * \brief  Every sprite in one texture, drawn in batches
+ *
+ * The sprites are scaled to one cell size when they are loaded, the size
+ * of a tile in pixels, and laid out on a grid in a single texture, so the
+ * renderer copies them 1:1 and where a sprite is in the atlas follows from
+ * its enum value and the cell size alone. A SpriteBatch collects the quads of
+ * a frame and draws all of them with one SDL_RenderGeometry() call.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_ATLAS_HPP__
+#define __BYTENOL_CHESS_ATLAS_HPP__
+
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+#include <SDL2/SDL.h>
+
+
+enum class Sprite : uint8_t
+{
+    SQUARE_DARK,
+    SQUARE_LIGHT,
+    SELECTED,
+    VISION,
+    // the pieces in CharacterName order, black then white
+    B_PAWN, B_ROOK, B_KNIGHT, B_BISHOP, B_KING, B_QUEEN,
+    W_PAWN, W_ROOK, W_KNIGHT, W_BISHOP, W_KING, W_QUEEN,
+    COUNT
+};
+
+constexpr int SPRITE_NB = static_cast<int>(Sprite::COUNT);
+
+constexpr Sprite pieceSprite(CharacterName name, int color)
+{
+    return static_cast<Sprite>(static_cast<int>(Sprite::B_PAWN) + color * 6 + static_cast<int>(name) - 1);
+}
+
+static_assert(pieceSprite(CharacterName::PAWN, BLACK) == Sprite::B_PAWN && pieceSprite(CharacterName::QUEEN, WHITE) == Sprite::W_QUEEN,
+    "the piece sprites follow CharacterName");
+
+
+namespace Atlas
+{
+    // transparent gap between cells, so filtering never picks up a neighbour
+    constexpr int PADDING = 2;
+    constexpr int COLUMNS = 4;
+    constexpr int ROWS = (SPRITE_NB + COLUMNS - 1) / COLUMNS;
+
+    constexpr int SheetWidth(int cellSize)
+    {
+        return COLUMNS * (cellSize + PADDING);
+    }
+
+    constexpr int SheetHeight(int cellSize)
+    {
+        return ROWS * (cellSize + PADDING);
+    }
+
+    constexpr SDL_Rect GetRect(Sprite sprite, int cellSize)
+    {
+        int i = static_cast<int>(sprite);
+        return { (i % COLUMNS) * (cellSize + PADDING), (i / COLUMNS) * (cellSize + PADDING), cellSize, cellSize };
+    }
+}
+
+
+// the game's files, under the assets directory and in the bundle made of it
+namespace Assets
+{
+    constexpr const char* SPRITES = "sprites/PNGs/With Shadow/";
+    constexpr const char* FONT = "SpecialGothic-Regular.ttf";
+
+    constexpr const char* BUNDLE = "assets.bundle";
+    constexpr const char* FONT_ENTRY = "font";
+
+    // the atlas sheet for cells of the size
+    inline std::string SheetEntry(int cellSize)
+    {
+        return "sprites/" + std::to_string(cellSize);
+    }
+}
+
+
+/**
+ * One of the sizes the sprites are shipped at, each in its own directory.
+ */
+struct SpriteSet
+{
+    const char* directory;
+    // follows the sprite name in the file name
+    const char* suffix;
+    // side of a square in the set, in pixels
+    int size;
+};
+
+/**
+ * The smallest set whose squares are at least the cell size, so sprites are
+ * only ever scaled down and by as little as possible, else the largest.
+ */
+const SpriteSet& chooseSpriteSet(int cellSize);
+
+
+class SpriteAtlas
+{
+public:
+    /**
+     * Decodes every sprite from the set under the directory that suits cells
+     * of cellSize pixels and scales it into its cell of an RGBA32 sheet, on
+     * up to threads threads. A sprite that cannot be loaded is logged and
+     * left transparent. The caller frees the sheet, nullptr when there is
+     * none at all.
+     */
+    static SDL_Surface* Compose(const std::string& directory, int cellSize, int threads);
+
+    /**
+     * Compose() and the upload, which is all that runs on the calling
+     * thread. It must own the renderer.
+     */
+    bool Load(SDL_Renderer* renderer, const std::string& directory, int cellSize, int threads);
+
+    /**
+     * Uploads a sheet laid out as Compose() does it, RGBA32 rows pitch bytes
+     * apart. False when there is no texture.
+     */
+    bool Load(SDL_Renderer* renderer, const void* pixels, int pitch, int cellSize);
+
+    void Destroy();
+
+    inline SDL_Texture* GetTexture() const
+    {
+        return texture;
+    }
+
+    inline SDL_Rect GetRect(Sprite sprite) const
+    {
+        return Atlas::GetRect(sprite, cellSize);
+    }
+
+    inline int GetWidth() const
+    {
+        return width;
+    }
+
+    inline int GetHeight() const
+    {
+        return height;
+    }
+
+private:
+    SDL_Texture* texture = nullptr;
+    int cellSize = 0;
+    int width = 0, height = 0;
+};
+
+
+/**
+ * The quads of a frame in drawing order, all from one texture.
+ */
+class SpriteBatch
+{
+public:
+    inline void Clear()
+    {
+        quads.clear();
+    }
+
+    inline void Add(const SpriteAtlas& atlas, Sprite sprite, const SDL_Rect& dest)
+    {
+        quads.push_back({ atlas.GetRect(sprite), dest, { 255, 255, 255, 255 } });
+    }
+
+    /**
+     * Any part of the texture the batch is drawn with, tinted by the color.
+     */
+    inline void Add(const SDL_Rect& source, const SDL_Rect& dest, SDL_Color color)
+    {
+        quads.push_back({ source, dest, color });
+    }
+
+    inline size_t Size() const
+    {
+        return quads.size();
+    }
+
+    inline void Draw(SDL_Renderer* renderer, const SpriteAtlas& atlas, bool batched = true)
+    {
+        Draw(renderer, atlas.GetTexture(), atlas.GetWidth(), atlas.GetHeight(), batched);
+    }
+
+    /**
+     * Draws the quads with one SDL_RenderGeometry() call, or with one
+     * SDL_RenderCopy() each when not batched, to compare the two.
+     */
+    void Draw(SDL_Renderer* renderer, SDL_Texture* texture, int width, int height, bool batched = true);
+
+private:
+    struct Quad
+    {
+        SDL_Rect source;
+        SDL_Rect dest;
+        SDL_Color color;
+    };
+
+    std::vector<Quad> quads;
+    // kept between frames so drawing does not allocate
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+};
+
+#endif
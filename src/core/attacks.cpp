@@ -0,0 +1,160 @@
+/*****************************************************************//**
+ * \file   attacks.cpp
+ * \brief  Attack table construction
+ *********************************************************************/
+
+#include "attacks.hpp"
+
+Attacks::Magic Attacks::rookMagics[SQUARE_NB];
+Attacks::Magic Attacks::bishopMagics[SQUARE_NB];
+
+Bitboard Attacks::rookTable[0x19000];
+Bitboard Attacks::bishopTable[0x1480];
+
+Bitboard Attacks::betweenTable[SQUARE_NB][SQUARE_NB];
+Bitboard Attacks::lineTable[SQUARE_NB][SQUARE_NB];
+
+const int Attacks::ROOK_DIRECTIONS[4][2] = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+const int Attacks::BISHOP_DIRECTIONS[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+
+namespace
+{
+    // xorshift64* generator, fixed seeds keep startup time deterministic
+    struct Prng
+    {
+        uint64_t s;
+
+        uint64_t Rand()
+        {
+            s ^= s >> 12;
+            s ^= s << 25;
+            s ^= s >> 27;
+            return s * 2685821657736338717ULL;
+        }
+
+        // magics with few set bits are found a lot faster
+        uint64_t SparseRand()
+        {
+            return Rand() & Rand() & Rand();
+        }
+    };
+}
+
+
+Bitboard Attacks::SlidingAttacks(int sq, Bitboard occupied, const int directions[4][2])
+{
+    Bitboard attacks = 0;
+
+    for (int d = 0; d < 4; d++)
+    {
+        int x = SquareX(sq) + directions[d][0];
+        int y = SquareY(sq) + directions[d][1];
+
+        while (x >= 0 && x < 8 && y >= 0 && y < 8)
+        {
+            int s = MakeSquare(x, y);
+            attacks |= SquareBB(s);
+            if (TestBit(occupied, s))
+                break;
+            x += directions[d][0];
+            y += directions[d][1];
+        }
+    }
+
+    return attacks;
+}
+
+
+void Attacks::InitMagics(Magic magics[], Bitboard table[], const int directions[4][2])
+{
+    [[maybe_unused]] Bitboard occupancy[4096];
+    Bitboard reference[4096];
+#if !defined(__BMI2__)
+    // per-row seeds that are known to find every magic quickly
+    const uint64_t seeds[8] = { 728, 2985, 110, 2501, 1289, 2821, 1699, 255 };
+    int epoch[4096] = {}, cnt = 0;
+#endif
+
+    for (int sq = 0; sq < SQUARE_NB; sq++)
+    {
+        // board edges are never blockers, unless the piece stands on that edge
+        Bitboard edges = ((RowBB(0) | RowBB(7)) & ~RowBB(SquareY(sq)))
+            | ((ColBB(0) | ColBB(7)) & ~ColBB(SquareX(sq)));
+
+        Magic& m = magics[sq];
+        m.mask = SlidingAttacks(sq, 0, directions) & ~edges;
+        m.shift = 64 - PopCount(m.mask);
+        m.attacks = sq == 0 ? table : magics[sq - 1].attacks + (size_t(1) << PopCount(magics[sq - 1].mask));
+
+        // enumerate every subset of the mask (carry-rippler) with its attack set
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            occupancy[size] = b;
+            reference[size] = SlidingAttacks(sq, b, directions);
+#if defined(__BMI2__)
+            m.attacks[_pext_u64(b, m.mask)] = reference[size];
+#endif
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+
+#if !defined(__BMI2__)
+        // try random candidates until one maps every subset without a destructive collision
+        Prng rng{ seeds[SquareY(sq)] };
+        for (int i = 0; i < size;)
+        {
+            for (m.magic = 0; PopCount((m.magic * m.mask) >> 56) < 6;)
+                m.magic = rng.SparseRand();
+
+            for (++cnt, i = 0; i < size; i++)
+            {
+                unsigned idx = m.Index(occupancy[i]);
+
+                if (epoch[idx] < cnt)
+                {
+                    epoch[idx] = cnt;
+                    m.attacks[idx] = reference[i];
+                }
+                else if (m.attacks[idx] != reference[i])
+                    break;
+            }
+        }
+#endif
+    }
+}
+
+
+void Attacks::Init()
+{
+    static bool initialized = false;
+    if (initialized) return;
+
+    InitMagics(rookMagics, rookTable, ROOK_DIRECTIONS);
+    InitMagics(bishopMagics, bishopTable, BISHOP_DIRECTIONS);
+    InitLines();
+    initialized = true;
+}
+
+
+void Attacks::InitLines()
+{
+    for (int a = 0; a < SQUARE_NB; a++)
+        for (int b = 0; b < SQUARE_NB; b++)
+        {
+            betweenTable[a][b] = lineTable[a][b] = 0;
+
+            for (auto directions : { ROOK_DIRECTIONS, BISHOP_DIRECTIONS })
+            {
+                Bitboard fromA = SlidingAttacks(a, 0, directions);
+                if (a == b || !TestBit(fromA, b))
+                    continue;
+
+                // the squares both see on an empty board are the full line, with
+                // each other as the only blocker they are the squares in between
+                lineTable[a][b] = (fromA & SlidingAttacks(b, 0, directions)) | SquareBB(a) | SquareBB(b);
+                betweenTable[a][b] = SlidingAttacks(a, SquareBB(b), directions) & SlidingAttacks(b, SquareBB(a), directions);
+            }
+        }
+}
@@ -0,0 +1,195 @@
+/*****************************************************************//**
+ * \file   attacks.hpp
+ * \brief  Precomputed attack tables
+ *
+ * Sliding pieces use magic bitboards: the blockers on a piece's rays are
+ * hashed into a per-square slot of one shared table, so the attacked
+ * squares for any occupancy come from a single lookup. When the target
+ * supports BMI2 the hash is replaced by PEXT.
+ *
+ * Knights, kings and pawns have fixed attack sets per square, those
+ * tables are generated at compile time. The pawn geometry of each color
+ * is also available as compile time constants and set-wise shifts, for
+ * code templated on the side to move.
+ *
+ * Attacks::Init() must be called once before the first slider lookup.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_ATTACKS_HPP__
+#define __BYTENOL_CHESS_ATTACKS_HPP__
+
+#include <array>
+
+#include "bitboard.hpp"
+#include "types.hpp"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+
+using AttackTable = std::array<Bitboard, SQUARE_NB>;
+
+constexpr int KNIGHT_OFFSETS[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+constexpr int KING_OFFSETS[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+
+// white pawns move towards row 0 and black pawns towards row 7, as laid out by initPlayers()
+constexpr int PAWN_CAPTURE_OFFSETS[2][2][2] = { { { -1, 1 }, { 1, 1 } }, { { -1, -1 }, { 1, -1 } } };
+constexpr int PAWN_PUSH_OFFSETS[2][1][2] = { { { 0, 1 } }, { { 0, -1 } } };
+
+constexpr Bitboard FILE_A_BB = ColBB(0);
+constexpr Bitboard FILE_H_BB = ColBB(7);
+
+// square offsets of one step forward and the two captures, as seen by each color
+template<Color Us> constexpr int PAWN_UP = Us == WHITE ? -8 : 8;
+template<Color Us> constexpr int PAWN_UP_LEFT = PAWN_UP<Us> - 1;
+template<Color Us> constexpr int PAWN_UP_RIGHT = PAWN_UP<Us> + 1;
+
+template<Color Us> constexpr int PAWN_START_ROW = Us == WHITE ? 6 : 1;
+template<Color Us> constexpr int PAWN_LAST_ROW = Us == WHITE ? 0 : 7;
+
+/**
+ * Moves every bit of the set by a square offset, offsets with a sideways
+ * step drop the bits that would wrap around the board edge.
+ */
+template<int Offset>
+constexpr Bitboard Shift(Bitboard b)
+{
+    constexpr int dx = ((Offset % 8) + 8 + 1) % 8 - 1;
+    if constexpr (dx == -1) b &= ~FILE_A_BB;
+    if constexpr (dx == 1) b &= ~FILE_H_BB;
+    return Offset > 0 ? b << Offset : b >> -Offset;
+}
+
+template<Color Us>
+constexpr Bitboard PawnAttacksBB(Bitboard pawns)
+{
+    return Shift<PAWN_UP_LEFT<Us>>(pawns) | Shift<PAWN_UP_RIGHT<Us>>(pawns);
+}
+
+
+template<size_t N>
+constexpr AttackTable MakeLeaperTable(const int (&offsets)[N][2])
+{
+    AttackTable table{};
+
+    for (int sq = 0; sq < SQUARE_NB; sq++)
+        for (const auto& o : offsets)
+        {
+            int x = SquareX(sq) + o[0];
+            int y = SquareY(sq) + o[1];
+            if (x >= 0 && x < 8 && y >= 0 && y < 8)
+                table[sq] |= SquareBB(MakeSquare(x, y));
+        }
+
+    return table;
+}
+
+
+class Attacks
+{
+    struct Magic
+    {
+        Bitboard mask;
+        Bitboard magic;
+        Bitboard* attacks;
+        unsigned shift;
+
+        inline unsigned Index(Bitboard occupied) const
+        {
+#if defined(__BMI2__)
+            return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+            return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+        }
+    };
+
+    static Magic rookMagics[SQUARE_NB];
+    static Magic bishopMagics[SQUARE_NB];
+
+    static Bitboard rookTable[0x19000];
+    static Bitboard bishopTable[0x1480];
+
+    static Bitboard betweenTable[SQUARE_NB][SQUARE_NB];
+    static Bitboard lineTable[SQUARE_NB][SQUARE_NB];
+
+    static void InitMagics(Magic magics[], Bitboard table[], const int directions[4][2]);
+
+    static void InitLines();
+
+public:
+    static constexpr AttackTable KNIGHT = MakeLeaperTable(KNIGHT_OFFSETS);
+    static constexpr AttackTable KING = MakeLeaperTable(KING_OFFSETS);
+
+    // indexed by [color][square], color 1 is white
+    static constexpr AttackTable PAWN[2] = { MakeLeaperTable(PAWN_CAPTURE_OFFSETS[0]), MakeLeaperTable(PAWN_CAPTURE_OFFSETS[1]) };
+    static constexpr AttackTable PAWN_PUSH[2] = { MakeLeaperTable(PAWN_PUSH_OFFSETS[0]), MakeLeaperTable(PAWN_PUSH_OFFSETS[1]) };
+
+    /**
+     * Builds the slider tables. Cheap enough to run at startup and safe to
+     * call more than once.
+     */
+    static void Init();
+
+    static inline Bitboard Rook(int sq, Bitboard occupied)
+    {
+        const Magic& m = rookMagics[sq];
+        return m.attacks[m.Index(occupied)];
+    }
+
+    static inline Bitboard Bishop(int sq, Bitboard occupied)
+    {
+        const Magic& m = bishopMagics[sq];
+        return m.attacks[m.Index(occupied)];
+    }
+
+    static inline Bitboard Knight(int sq)
+    {
+        return KNIGHT[sq];
+    }
+
+    static inline Bitboard King(int sq)
+    {
+        return KING[sq];
+    }
+
+    static inline Bitboard Pawn(int color, int sq)
+    {
+        return PAWN[color][sq];
+    }
+
+    static inline Bitboard Queen(int sq, Bitboard occupied)
+    {
+        return Rook(sq, occupied) | Bishop(sq, occupied);
+    }
+
+    /**
+     * Squares strictly between two squares on a shared rank, file or
+     * diagonal, empty when they are not aligned.
+     */
+    static inline Bitboard Between(int a, int b)
+    {
+        return betweenTable[a][b];
+    }
+
+    /**
+     * The whole rank, file or diagonal through both squares, empty when
+     * they are not aligned.
+     */
+    static inline Bitboard Line(int a, int b)
+    {
+        return lineTable[a][b];
+    }
+
+    /**
+     * Slow ray walk used to fill the tables, exposed so callers can
+     * cross-check the lookups.
+     */
+    static Bitboard SlidingAttacks(int sq, Bitboard occupied, const int directions[4][2]);
+
+    static const int ROOK_DIRECTIONS[4][2];
+    static const int BISHOP_DIRECTIONS[4][2];
+};
+
+#endif
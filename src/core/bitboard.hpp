@@ -0,0 +1,78 @@
+/*****************************************************************//**
+ * \file   bitboard.hpp
+ * \brief  64-bit board helpers shared by the collision board and movegen
+ *
+ * Squares are numbered row by row from the top-left corner of the
+ * window, i.e sq = y * 8 + x, so bit 0 is (0, 0) and bit 63 is (7, 7).
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_BITBOARD_HPP__
+#define __BYTENOL_CHESS_BITBOARD_HPP__
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+
+
+using Bitboard = uint64_t;
+
+constexpr int SQUARE_NB = 64;
+
+
+constexpr inline int MakeSquare(int x, int y)
+{
+    return y * 8 + x;
+}
+
+constexpr inline int SquareX(int sq)
+{
+    return sq & 7;
+}
+
+constexpr inline int SquareY(int sq)
+{
+    return sq >> 3;
+}
+
+constexpr inline Bitboard SquareBB(int sq)
+{
+    return Bitboard(1) << sq;
+}
+
+constexpr inline bool TestBit(Bitboard b, int sq)
+{
+    return (b >> sq) & 1;
+}
+
+constexpr inline Bitboard RowBB(int y)
+{
+    return Bitboard(0xFF) << (8 * y);
+}
+
+constexpr inline Bitboard ColBB(int x)
+{
+    return Bitboard(0x0101010101010101ULL) << x;
+}
+
+inline int PopCount(Bitboard b)
+{
+    return std::popcount(b);
+}
+
+inline int Lsb(Bitboard b)
+{
+    return std::countr_zero(b);
+}
+
+/**
+ * Returns the lowest set square and clears it from the board.
+ * The board must not be empty.
+ */
+inline int PopLsb(Bitboard& b)
+{
+    int sq = Lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+#endif
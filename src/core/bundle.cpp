@@ -0,0 +1,143 @@
+/*****************************************************************//**
+ * \file   bundle.cpp
+ * \brief  Assets packed into one file, used in place from its mapping
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstring>
+
+#include "bundle.hpp"
+
+namespace
+{
+    uint32_t readLe(const char* p, int bytes)
+    {
+        uint32_t value = 0;
+        for (int i = bytes - 1; i >= 0; i--)
+            value = (value << 8) | static_cast<uint8_t>(p[i]);
+        return value;
+    }
+
+    void writeLe(std::string& out, uint32_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++)
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    size_t alignUp(size_t offset)
+    {
+        return (offset + Bundle::ALIGNMENT - 1) / Bundle::ALIGNMENT * Bundle::ALIGNMENT;
+    }
+}
+
+
+bool AssetBundle::Open(const char* path)
+{
+    Close();
+
+    if (!file.Open(path))
+        return false;
+
+    const char* data = file.Data();
+    size_t size = file.Size();
+    if (size < Bundle::HEADER_SIZE || std::memcmp(data, Bundle::MAGIC, sizeof(Bundle::MAGIC))
+        || readLe(data + 4, 2) != Bundle::VERSION)
+    {
+        Close();
+        return false;
+    }
+
+    size_t count = readLe(data + 6, 2);
+    if (size < Bundle::HEADER_SIZE + count * Bundle::ENTRY_SIZE)
+    {
+        Close();
+        return false;
+    }
+
+    entries.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const char* p = data + Bundle::HEADER_SIZE + i * Bundle::ENTRY_SIZE;
+        size_t offset = readLe(p + 32, 4), bytes = readLe(p + 36, 4);
+
+        BundleEntry entry;
+        entry.name = std::string_view(p, strnlen(p, Bundle::NAME_SIZE));
+        entry.width = static_cast<int>(readLe(p + 40, 4));
+        entry.height = static_cast<int>(readLe(p + 44, 4));
+
+        // a bundle cut short or an image of the wrong size is not used at all
+        bool fits = offset <= size && bytes <= size - offset;
+        bool sized = !entry.IsImage() || bytes == static_cast<size_t>(entry.width) * entry.height * 4;
+        if (!fits || !sized)
+        {
+            Close();
+            return false;
+        }
+
+        entry.data = std::string_view(data + offset, bytes);
+        entries.push_back(entry);
+    }
+
+    return true;
+}
+
+
+void AssetBundle::Close()
+{
+    entries.clear();
+    file.Close();
+}
+
+
+const BundleEntry* AssetBundle::Find(std::string_view name) const
+{
+    for (const auto& entry : entries)
+        if (entry.name == name)
+            return &entry;
+
+    return nullptr;
+}
+
+
+void BundleWriter::Add(std::string_view name, std::string data, int width, int height)
+{
+    items.push_back({ std::string(name.substr(0, Bundle::NAME_SIZE - 1)), std::move(data), width, height });
+}
+
+
+bool BundleWriter::Write(const char* path) const
+{
+    std::string header(Bundle::MAGIC, sizeof(Bundle::MAGIC));
+    writeLe(header, Bundle::VERSION, 2);
+    writeLe(header, static_cast<uint32_t>(items.size()), 2);
+
+    size_t offset = alignUp(Bundle::HEADER_SIZE + items.size() * Bundle::ENTRY_SIZE);
+    for (const auto& item : items)
+    {
+        std::string name = item.name;
+        name.resize(Bundle::NAME_SIZE, '\0');
+        header += name;
+        writeLe(header, static_cast<uint32_t>(offset), 4);
+        writeLe(header, static_cast<uint32_t>(item.data.size()), 4);
+        writeLe(header, static_cast<uint32_t>(item.width), 4);
+        writeLe(header, static_cast<uint32_t>(item.height), 4);
+        offset = alignUp(offset + item.data.size());
+    }
+
+    std::FILE* out = std::fopen(path, "wb");
+    if (!out)
+        return false;
+
+    std::string padding;
+    bool written = std::fwrite(header.data(), 1, header.size(), out) == header.size();
+    size_t position = header.size();
+    for (const auto& item : items)
+    {
+        padding.assign(alignUp(position) - position, '\0');
+        written = written && std::fwrite(padding.data(), 1, padding.size(), out) == padding.size()
+            && std::fwrite(item.data.data(), 1, item.data.size(), out) == item.data.size();
+        position = alignUp(position) + item.data.size();
+    }
+
+    return std::fclose(out) == 0 && written;
+}
@@ -0,0 +1,113 @@
+/*****************************************************************//**
+ * \file   bundle.hpp
+ * \brief  Assets packed into one file, used in place from its mapping
+ *
+ * An 8 byte header ("CAB1", the version and the number of entries, 16-bit
+ * little endian each) is followed by the entries, 48 bytes each:
+ *
+ *  name     32 bytes, padded with NULs
+ *  offset   where the data starts, from the start of the file
+ *  size     of the data in bytes
+ *  width    in pixels for an image, 0 for anything else
+ *  height   in pixels for an image, 0 for anything else
+ *
+ * all 32-bit little endian, then the data. Images are decoded RGBA32 rows
+ * without padding, so a texture is made straight from the mapped bytes,
+ * and every entry starts on a 16 byte boundary.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_BUNDLE_HPP__
+#define __BYTENOL_CHESS_BUNDLE_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mappedfile.hpp"
+
+
+namespace Bundle
+{
+    constexpr char MAGIC[4] = { 'C', 'A', 'B', '1' };
+    constexpr uint16_t VERSION = 1;
+    constexpr size_t HEADER_SIZE = 8;
+    constexpr size_t ENTRY_SIZE = 48;
+    constexpr size_t NAME_SIZE = 32;
+    constexpr size_t ALIGNMENT = 16;
+}
+
+
+struct BundleEntry
+{
+    std::string_view name;
+    std::string_view data;
+    int width = 0, height = 0;
+
+    inline bool IsImage() const
+    {
+        return width > 0 && height > 0;
+    }
+};
+
+
+class AssetBundle
+{
+public:
+    /**
+     * Maps the bundle, closing the one mapped before. False when the file
+     * cannot be mapped, is not a bundle, or an entry does not fit in it.
+     */
+    bool Open(const char* path);
+
+    void Close();
+
+    inline bool IsOpen() const
+    {
+        return file.IsOpen();
+    }
+
+    /**
+     * The entry with the name, nullptr if there is none. The data stays
+     * valid until the bundle is closed.
+     */
+    const BundleEntry* Find(std::string_view name) const;
+
+    inline const std::vector<BundleEntry>& GetEntries() const
+    {
+        return entries;
+    }
+
+private:
+    MappedFile file;
+    std::vector<BundleEntry> entries;
+};
+
+
+class BundleWriter
+{
+public:
+    /**
+     * An image is width * height RGBA32 pixels, anything else is added with
+     * no size. Names longer than Bundle::NAME_SIZE - 1 are cut.
+     */
+    void Add(std::string_view name, std::string data, int width = 0, int height = 0);
+
+    /**
+     * Writes every entry added, false when the file cannot be written.
+     */
+    bool Write(const char* path) const;
+
+private:
+    struct Item
+    {
+        std::string name;
+        std::string data;
+        int width, height;
+    };
+
+    std::vector<Item> items;
+};
+
+#endif
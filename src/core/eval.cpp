@@ -0,0 +1,116 @@
+/*****************************************************************//**
+ * \file   eval.cpp
+ * \brief  Static evaluation
+ *********************************************************************/
+
+#include "eval.hpp"
+
+namespace
+{
+    // from white's point of view, row 0 is the far side of the board
+    constexpr int PAWN_TABLE[SQUARE_NB] = {
+         0,  0,  0,  0,  0,  0,  0,  0,
+        50, 50, 50, 50, 50, 50, 50, 50,
+        10, 10, 20, 30, 30, 20, 10, 10,
+         5,  5, 10, 25, 25, 10,  5,  5,
+         0,  0,  0, 20, 20,  0,  0,  0,
+         5, -5,-10,  0,  0,-10, -5,  5,
+         5, 10, 10,-20,-20, 10, 10,  5,
+         0,  0,  0,  0,  0,  0,  0,  0,
+    };
+
+    constexpr int KNIGHT_TABLE[SQUARE_NB] = {
+        -50,-40,-30,-30,-30,-30,-40,-50,
+        -40,-20,  0,  0,  0,  0,-20,-40,
+        -30,  0, 10, 15, 15, 10,  0,-30,
+        -30,  5, 15, 20, 20, 15,  5,-30,
+        -30,  0, 15, 20, 20, 15,  0,-30,
+        -30,  5, 10, 15, 15, 10,  5,-30,
+        -40,-20,  0,  5,  5,  0,-20,-40,
+        -50,-40,-30,-30,-30,-30,-40,-50,
+    };
+
+    constexpr int BISHOP_TABLE[SQUARE_NB] = {
+        -20,-10,-10,-10,-10,-10,-10,-20,
+        -10,  0,  0,  0,  0,  0,  0,-10,
+        -10,  0,  5, 10, 10,  5,  0,-10,
+        -10,  5,  5, 10, 10,  5,  5,-10,
+        -10,  0, 10, 10, 10, 10,  0,-10,
+        -10, 10, 10, 10, 10, 10, 10,-10,
+        -10,  5,  0,  0,  0,  0,  5,-10,
+        -20,-10,-10,-10,-10,-10,-10,-20,
+    };
+
+    constexpr int ROOK_TABLE[SQUARE_NB] = {
+         0,  0,  0,  0,  0,  0,  0,  0,
+         5, 10, 10, 10, 10, 10, 10,  5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+         0,  0,  0,  5,  5,  0,  0,  0,
+    };
+
+    constexpr int QUEEN_TABLE[SQUARE_NB] = {
+        -20,-10,-10, -5, -5,-10,-10,-20,
+        -10,  0,  0,  0,  0,  0,  0,-10,
+        -10,  0,  5,  5,  5,  5,  0,-10,
+         -5,  0,  5,  5,  5,  5,  0, -5,
+          0,  0,  5,  5,  5,  5,  0, -5,
+        -10,  5,  5,  5,  5,  5,  0,-10,
+        -10,  0,  5,  0,  0,  0,  0,-10,
+        -20,-10,-10, -5, -5,-10,-10,-20,
+    };
+
+    constexpr int KING_TABLE[SQUARE_NB] = {
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -20,-30,-30,-40,-40,-30,-30,-20,
+        -10,-20,-20,-20,-20,-20,-20,-10,
+         20, 20,  0,  0,  0,  0, 20, 20,
+         20, 30, 10,  0,  0, 10, 30, 20,
+    };
+
+    // indexed by CharacterName
+    constexpr const int* PIECE_TABLES[CHARACTER_NB] = {
+        nullptr, PAWN_TABLE, ROOK_TABLE, KNIGHT_TABLE, BISHOP_TABLE, KING_TABLE, QUEEN_TABLE
+    };
+
+    template<Color Us>
+    int evaluateSide(const Position& position)
+    {
+        // black reads the tables upside down
+        constexpr int FLIP = Us == WHITE ? 0 : 56;
+
+        int score = position.GetMaterial(Us) * CENTIPAWNS;
+
+        for (int n = 1; n < CHARACTER_NB; n++)
+        {
+            Bitboard b = position.GetPieces(Us, static_cast<CharacterName>(n));
+            while (b)
+                score += PIECE_TABLES[n][PopLsb(b) ^ FLIP];
+        }
+
+        return score;
+    }
+}
+
+
+template<Color Us>
+int evaluate(const Position& position)
+{
+    return evaluateSide<Us>(position) - evaluateSide<Color(Us ^ 1)>(position);
+}
+
+
+int evaluate(const Position& position)
+{
+    return position.GetSideToMove() == WHITE ? evaluate<WHITE>(position) : evaluate<BLACK>(position);
+}
+
+
+template int evaluate<WHITE>(const Position& position);
+template int evaluate<BLACK>(const Position& position);
@@ -0,0 +1,26 @@
+/*****************************************************************//**
+ * \file   eval.hpp
+ * \brief  Static evaluation
+ *
+ * Material uses the same points as PIECE_POINTS (pawn 1, knight and
+ * bishop 3, rook 5, queen 9) scaled to centipawns, plus small
+ * piece-square bonuses so the engine develops its pieces and pushes pawns
+ * instead of shuffling when no material can be won.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_EVAL_HPP__
+#define __BYTENOL_CHESS_EVAL_HPP__
+
+#include "position.hpp"
+
+constexpr int CENTIPAWNS = 100;
+
+/**
+ * Score in centipawns from the point of view of the side to move.
+ */
+int evaluate(const Position& position);
+
+template<Color Us>
+int evaluate(const Position& position);
+
+#endif
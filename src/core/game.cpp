@@ -0,0 +1,358 @@
+/*****************************************************************//**
+ * \file   game.cpp
+ * \brief  Chess rules: pieces, players and the collision board
+ *********************************************************************/
+
+#include "game.hpp"
+#include "movegen.hpp"
+
+Player *currentPlayer = nullptr, 
+    *nextPlayer = nullptr, 
+    *whitePlayer = nullptr, 
+    *blackPlayer = nullptr;
+    
+Player player1, player2;
+
+Position CollisionBoard::position;
+GameLogWriter Logger::writer;
+
+
+Player::path_t Player::GetPath(int slot) const
+{
+    path_t path;
+    auto& position = CollisionBoard::GetPosition();
+
+    // only the side to move has anywhere to go
+    if (!pieces.IsActive(slot) || pieces.colors[slot] != position.GetSideToMove())
+        return path;
+
+    MoveList legal;
+    generateLegal(position, legal);
+
+    int sq = pieces.squares[slot];
+    for (auto move : legal)
+        if (move.From() == sq)
+            path.Add(move);
+    return path;
+}
+
+
+bool Player::MoveTo(int slot, Point2D dest, CharacterName promotion)
+{
+    int to = MakeSquare(dest.x, dest.y);
+
+    // the path is legal already, a promotion is there once for every piece
+    for (auto move : GetPath(slot))
+        if (move.To() == to && (!move.IsPromotion() || move.GetPromotion() == promotion))
+            return playMove(move);
+
+    return false;
+}
+
+
+namespace
+{
+    inline Player* playerOf(int color)
+    {
+        return color == WHITE ? whitePlayer : blackPlayer;
+    }
+
+    inline Point2D toPoint(int sq)
+    {
+        return { SquareX(sq), SquareY(sq) };
+    }
+
+    // the pawn taken en passant stands beside the capturing pawn, not on its destination
+    inline int capturedSquare(Move move)
+    {
+        return move.Flags() == Move::EN_PASSANT ? MakeSquare(SquareX(move.To()), SquareY(move.From())) : move.To();
+    }
+
+    inline void castleRookSquares(Move move, int& rookFrom, int& rookTo)
+    {
+        bool kingSide = move.To() > move.From();
+        rookFrom = kingSide ? move.To() + 1 : move.To() - 2;
+        rookTo = kingSide ? move.To() - 1 : move.To() + 1;
+    }
+
+    /**
+     * Plays the move on the pieces of both players, not on the position,
+     * and fills in what it takes to undo it.
+     */
+    bool playTurn(Move move, MoveHistory::Turn& turn)
+    {
+        int us = CollisionBoard::GetPosition().GetSideToMove();
+        Player* mover = playerOf(us);
+        Player* opponent = playerOf(us ^ 1);
+        int from = move.From(), to = move.To();
+
+        int piece = mover->GetPieceAt(toPoint(from));
+        if (piece == Player::NO_PIECE)
+            return false;
+
+        turn = MoveHistory::Turn{};
+        turn.piece = static_cast<int8_t>(piece);
+        turn.pieceFlags = mover->GetPieces().flags[piece];
+
+        if (move.IsCapture())
+        {
+            int captured = opponent->GetPieceAt(toPoint(capturedSquare(move)));
+            if (captured != Player::NO_PIECE)
+            {
+                turn.captured = static_cast<int8_t>(captured);
+                turn.points = static_cast<int16_t>(PIECE_POINTS[static_cast<int>(opponent->GetPieceName(captured))]);
+                mover->AddScore(turn.points);
+                opponent->RemovePiece(captured);
+            }
+        }
+
+        mover->MovePiece(piece, toPoint(to));
+
+        if (move.IsCastle())
+        {
+            int rookFrom, rookTo;
+            castleRookSquares(move, rookFrom, rookTo);
+            int rook = mover->GetPieceAt(toPoint(rookFrom));
+            if (rook != Player::NO_PIECE)
+            {
+                turn.rook = static_cast<int8_t>(rook);
+                turn.rookFlags = mover->GetPieces().flags[rook];
+                mover->MovePiece(rook, toPoint(rookTo));
+            }
+        }
+        else if (move.IsPromotion())
+            mover->Promote(piece, move.GetPromotion());
+
+        return true;
+    }
+
+    // the side to move of the position is the current player
+    void handOver()
+    {
+        currentPlayer = playerOf(CollisionBoard::GetPosition().GetSideToMove());
+        nextPlayer = currentPlayer == whitePlayer ? blackPlayer : whitePlayer;
+    }
+}
+
+
+MoveStack MoveHistory::stack{ CollisionBoard::GetPosition() };
+std::vector<MoveHistory::Turn> MoveHistory::turns;
+
+
+bool playMove(Move move)
+{
+    MoveHistory::Turn turn;
+    if (!playTurn(move, turn))
+        return false;
+
+    auto& turns = MoveHistory::turns;
+    turns.resize(MoveHistory::stack.GetPly());
+    turns.push_back(turn);
+    MoveHistory::stack.Push(move);
+    return true;
+}
+
+
+void MoveHistory::Clear()
+{
+    stack.Clear();
+    turns.clear();
+}
+
+
+bool MoveHistory::Undo()
+{
+    if (!stack.CanUndo())
+        return false;
+
+    size_t ply = stack.GetPly() - 1;
+    Move move = stack[ply];
+    const Turn& turn = turns[ply];
+    stack.Undo();
+
+    int us = CollisionBoard::GetPosition().GetSideToMove();
+    Player* mover = playerOf(us);
+    Player* opponent = playerOf(us ^ 1);
+
+    if (move.IsPromotion())
+        mover->Promote(turn.piece, CharacterName::PAWN);
+    mover->PlacePiece(turn.piece, toPoint(move.From()), turn.pieceFlags);
+
+    if (turn.rook != Player::NO_PIECE)
+    {
+        int rookFrom, rookTo;
+        castleRookSquares(move, rookFrom, rookTo);
+        mover->PlacePiece(turn.rook, toPoint(rookFrom), turn.rookFlags);
+    }
+
+    if (turn.captured != Player::NO_PIECE)
+    {
+        opponent->RestorePiece(turn.captured);
+        mover->AddScore(-turn.points);
+    }
+
+    handOver();
+    return true;
+}
+
+
+bool MoveHistory::Redo()
+{
+    if (!stack.CanRedo())
+        return false;
+
+    size_t ply = stack.GetPly();
+    if (!playTurn(stack[ply], turns[ply]))
+        return false;
+
+    stack.Redo();
+    handOver();
+    return true;
+}
+
+
+bool initPlayers(std::string_view fen)
+{
+    auto& position = CollisionBoard::GetPosition();
+    if (!position.SetFen(fen))
+        return false;
+
+    bool player1IsWhite = true;
+    whitePlayer = player1IsWhite ? &player1 : &player2;
+    blackPlayer = player1IsWhite ? &player2 : &player1;
+    currentPlayer = position.GetSideToMove() == WHITE ? whitePlayer : blackPlayer;
+    nextPlayer = currentPlayer == whitePlayer ? blackPlayer : whitePlayer;
+
+    // the pieces are read off the position, from here on both only change through moves
+    player1.Reset(player1IsWhite, false);
+    player2.Reset(!player1IsWhite, true);
+    MoveHistory::Clear();
+    return true;
+}
+
+
+void Player::Reset(bool _isWhite, bool _isTop)
+{
+    pieces.count = 0;
+    std::fill(std::begin(squares), std::end(squares), NO_PIECE);
+    score = 0;
+
+    isWhite = _isWhite;
+    isTop = _isTop;
+
+    Bitboard own = CollisionBoard::GetColorPieces(GetColor());
+    while (own)
+    {
+        int sq = PopLsb(own);
+        AddPiece(CollisionBoard::GetPosition().GetNameAt(sq), { SquareX(sq), SquareY(sq) });
+    }
+}
+
+
+void Player::AddPiece(CharacterName name, Point2D pos)
+{
+    int slot = pieces.count++;
+    int sq = MakeSquare(pos.x, pos.y);
+
+    pieces.names[slot] = name;
+    pieces.colors[slot] = static_cast<uint8_t>(GetColor());
+    pieces.squares[slot] = static_cast<uint8_t>(sq);
+    pieces.flags[slot] = PieceSet::ACTIVE;
+    squares[sq] = static_cast<int8_t>(slot);
+}
+
+
+void Player::MovePiece(int slot, Point2D dest)
+{
+    int sq = MakeSquare(dest.x, dest.y);
+    squares[pieces.squares[slot]] = NO_PIECE;
+    squares[sq] = static_cast<int8_t>(slot);
+    pieces.squares[slot] = static_cast<uint8_t>(sq);
+    pieces.flags[slot] |= PieceSet::MOVED;
+}
+
+
+void Player::PlacePiece(int slot, Point2D pos, uint8_t flags)
+{
+    int sq = MakeSquare(pos.x, pos.y);
+    if (pieces.IsActive(slot))
+        squares[pieces.squares[slot]] = NO_PIECE;
+
+    pieces.squares[slot] = static_cast<uint8_t>(sq);
+    pieces.flags[slot] = flags;
+    if (flags & PieceSet::ACTIVE)
+        squares[sq] = static_cast<int8_t>(slot);
+}
+
+
+void Player::RemovePiece(int slot)
+{
+    squares[pieces.squares[slot]] = NO_PIECE;
+    pieces.flags[slot] &= ~PieceSet::ACTIVE;
+}
+
+
+void Player::RestorePiece(int slot)
+{
+    squares[pieces.squares[slot]] = static_cast<int8_t>(slot);
+    pieces.flags[slot] |= PieceSet::ACTIVE;
+}
+
+
+void Player::Promote(int slot, CharacterName name)
+{
+    pieces.names[slot] = name;
+}
+
+
+bool Logger::Open(const char* path)
+{
+    return writer.Open(path);
+}
+
+
+void Logger::NewGame()
+{
+    writer.BeginGame(CollisionBoard::GetPosition());
+    writer.Flush();
+}
+
+
+void Logger::NextTurn()
+{
+    auto& position = CollisionBoard::GetPosition();
+    Move move = position.GetState().move;
+
+    // the first move after a takeback starts a game from where it is played
+    if (writer.IsOpen() && !writer.InGame())
+    {
+        position.UnmakeMove();
+        writer.BeginGame(position);
+        position.MakeMove(move);
+    }
+
+    writer.AddMove(move, position.GetKey());
+
+    auto result = gameResult(position);
+    if (result != GameResult::UNKNOWN)
+        writer.EndGame(result);
+
+    // the game is on disk after every move, whatever happens to the window
+    writer.Flush();
+}
+
+
+void Logger::TakeBack()
+{
+    if (!writer.InGame())
+        return;
+
+    writer.EndGame(GameResult::UNKNOWN);
+    writer.Flush();
+}
+
+
+void Logger::Close()
+{
+    writer.Close();
+}
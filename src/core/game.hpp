@@ -0,0 +1,338 @@
+/*****************************************************************//**
+ * \file   game.hpp
+ * \brief  Chess rules: pieces, players and the collision board
+ *
+ * Everything in here is independent of SDL so the rules can run headless,
+ * the window, textures and input live in main.cpp.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_GAME_HPP__
+#define __BYTENOL_CHESS_GAME_HPP__
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <algorithm>
+
+#include "bitboard.hpp"
+#include "attacks.hpp"
+#include "types.hpp"
+#include "position.hpp"
+#include "movelist.hpp"
+#include "movestack.hpp"
+#include "gamelog.hpp"
+
+
+// forward classes declaration
+struct Point2D;
+class Player;
+class CollisionBoard;
+
+extern Player player1, player2;
+extern Player *currentPlayer, *nextPlayer, *whitePlayer, *blackPlayer;
+
+
+/**
+ * Sets up the board from a FEN and both players from the board, the side
+ * to move becomes the current player. False when the FEN is not valid.
+ */
+bool initPlayers(std::string_view fen = Position::START_FEN);
+
+/**
+ * Plays a move for the current player on the position and on the pieces
+ * of both players, including the rook of a castle, the pawn taken en passant
+ * and promotions, and records it in the MoveHistory. Returns false if the
+ * current player has no piece on the move's square. The caller hands the
+ * turn over.
+ */
+bool playMove(Move move);
+
+
+struct Point2D
+{
+    int x, y;
+};
+
+
+/**
+ * The pieces of one player, one byte per field and piece, indexed by slot.
+ * A slot never moves: a captured piece only loses its ACTIVE flag and a
+ * promoted pawn changes its name in place.
+ */
+struct PieceSet
+{
+    static constexpr int CAPACITY = 16;
+
+    enum Flag : uint8_t
+    {
+        ACTIVE = 1,
+        MOVED = 2
+    };
+
+    // 4 x 16 bytes, a whole player fits one cache line
+    CharacterName names[CAPACITY];
+    uint8_t colors[CAPACITY];
+    uint8_t squares[CAPACITY];
+    uint8_t flags[CAPACITY];
+    int count = 0;
+
+    inline bool IsActive(int slot) const
+    {
+        return flags[slot] & ACTIVE;
+    }
+
+    inline bool HasMoved(int slot) const
+    {
+        return flags[slot] & MOVED;
+    }
+
+    inline Point2D GetPos(int slot) const
+    {
+        return { SquareX(squares[slot]), SquareY(squares[slot]) };
+    }
+};
+
+
+class Player
+{
+
+    PieceSet pieces;
+    // the slot of the active piece standing on each square, kept in sync by the methods below
+    int8_t squares[SQUARE_NB];
+    int score = 0;
+
+public:
+    static constexpr int NO_PIECE = -1;
+
+    using path_t = MoveList;
+
+    bool isWhite = false;
+    bool isTop = false;
+    
+    Player() = default;
+
+    /**
+     * Takes the pieces of the player's color from the collision board.
+     */
+    void Reset(bool _isWhite, bool _isTop);
+
+    /**
+     * Slot of the player's piece on the square, or NO_PIECE.
+     */
+    inline int GetPieceAt(Point2D pos) const
+    {
+        return squares[MakeSquare(pos.x, pos.y)];
+    }
+
+    /**
+     * The legal moves of the piece, empty when the player is not to move.
+     */
+    path_t GetPath(int slot) const;
+
+    /**
+     * Moves the piece along its path, for moves picked on the board.
+     * @param dest is the destination to move the piece to
+     * @param promotion is the piece a pawn reaching the last row becomes
+     */
+    bool MoveTo(int slot, Point2D dest, CharacterName promotion = CharacterName::QUEEN);
+
+    void MovePiece(int slot, Point2D dest);
+
+    /**
+     * Puts the piece on the square with the flags it had there, to take a
+     * move back.
+     */
+    void PlacePiece(int slot, Point2D pos, uint8_t flags);
+
+    /**
+     * Takes the piece off the board, its slot stays as inactive.
+     */
+    void RemovePiece(int slot);
+
+    /**
+     * Puts a piece taken off by RemovePiece() back where it was.
+     */
+    void RestorePiece(int slot);
+
+    void Promote(int slot, CharacterName name);
+
+    inline const PieceSet& GetPieces() const
+    {
+        return pieces;
+    };
+
+    inline CharacterName GetPieceName(int slot) const
+    {
+        return pieces.names[slot];
+    }
+
+    inline int GetColor() const
+    {
+        return isWhite ? 1 : 0;
+    };
+
+    inline void AddScore(int s)
+    {
+        score += s;
+    };
+
+    inline int GetScore() const
+    {
+        return score;
+    }
+
+    inline std::string GetName()
+    {
+        return isWhite ? "White" : "Black";
+    };
+
+private:
+    void AddPiece(CharacterName name, Point2D pos);
+};
+
+
+/**
+ * Read only view of the game position for the piece path logic.
+ * The position is only touched when a move is played, never per frame.
+ */
+class CollisionBoard
+{
+    static Position position;
+
+public:
+    static const size_t COL_SIZE = 8;
+    static const size_t ROW_SIZE = 8;
+    static const size_t TILE_SIZE = 64;
+
+    static inline Position& GetPosition()
+    {
+        return position;
+    }
+
+    static inline CharacterName GetNameAt(int x, int y)
+    {
+        return position.GetNameAt(MakeSquare(x, y));
+    }
+
+    static inline int GetColorAt(int x, int y)
+    {
+        return position.GetColorAt(MakeSquare(x, y));
+    }
+
+    static inline Bitboard GetPieces(int color, CharacterName name)
+    {
+        return position.GetPieces(color, name);
+    }
+
+    static inline Bitboard GetColorPieces(int color)
+    {
+        return position.GetColorPieces(color);
+    }
+
+    static inline Bitboard GetOccupied()
+    {
+        return position.GetOccupied();
+    }
+};
+
+
+/**
+ * The moves played on the collision board with playMove(), and what the
+ * players need to take each one back. The position takes a move back from
+ * its own undo stack and the players from the turn, so Undo() and Redo()
+ * cost the same at move 5 as at move 500. Both hand the turn over.
+ */
+class MoveHistory
+{
+public:
+    // the pieces a move changed, slots are Player::NO_PIECE when unused
+    struct Turn
+    {
+        int8_t piece = Player::NO_PIECE;
+        int8_t captured = Player::NO_PIECE;
+        int8_t rook = Player::NO_PIECE;
+        // flags before the move, which marks the pieces as moved
+        uint8_t pieceFlags = 0;
+        uint8_t rookFlags = 0;
+        // the points the capture earned
+        int16_t points = 0;
+    };
+
+    /**
+     * Forgets every move, the position on the collision board becomes ply 0.
+     */
+    static void Clear();
+
+    /**
+     * Takes the last move back.
+     */
+    static bool Undo();
+
+    /**
+     * Plays the last move taken back again.
+     */
+    static bool Redo();
+
+    static inline bool CanUndo()
+    {
+        return stack.CanUndo();
+    }
+
+    static inline bool CanRedo()
+    {
+        return stack.CanRedo();
+    }
+
+    static inline size_t GetPly()
+    {
+        return stack.GetPly();
+    }
+
+    // the move played at a ply from the start of the history
+    static inline Move GetMove(size_t ply)
+    {
+        return stack[ply];
+    }
+
+private:
+    static MoveStack stack;
+    // one per move of the stack, the ones taken back included
+    static std::vector<Turn> turns;
+
+    friend bool playMove(Move move);
+};
+
+
+/**
+ * Records the game on the collision board in the binary game log, move by
+ * move as it is played. Nothing is written before Open() succeeds.
+ */
+class Logger
+{
+    static GameLogWriter writer;
+
+public:
+    static bool Open(const char* path);
+
+    /**
+     * Starts a game from the position on the collision board.
+     */
+    static void NewGame();
+
+    /**
+     * Logs the move just played on the collision board, and the result
+     * once it ends the game.
+     */
+    static void NextTurn();
+
+    /**
+     * Ends the logged game at a move taken back, the next move starts a new
+     * game from the position it is played in.
+     */
+    static void TakeBack();
+
+    static void Close();
+};
+
+#endif
@@ -0,0 +1,467 @@
+/*****************************************************************//**
+ * \file   gamelog.cpp
+ * \brief  Compact, append only binary log of played games
+ *********************************************************************/
+
+#include <cstring>
+#include <string>
+
+#include "gamelog.hpp"
+#include "movegen.hpp"
+#include "pgn.hpp"
+
+namespace
+{
+    // days since 1970-01-01 of a proleptic Gregorian date
+    int64_t daysFromCivil(int64_t y, int m, int d)
+    {
+        y -= m <= 2;
+        int64_t era = (y >= 0 ? y : y - 399) / 400;
+        int64_t yearOfEra = y - era * 400;
+        int64_t dayOfYear = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    // the date of a day counted from 1970-01-01, the inverse of daysFromCivil()
+    void civilFromDays(int64_t days, int64_t& y, int& m, int& d)
+    {
+        days += 719468;
+        int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        int64_t dayOfEra = days - era * 146097;
+        int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int64_t mp = (5 * dayOfYear + 2) / 153;
+        d = static_cast<int>(dayOfYear - (153 * mp + 2) / 5 + 1);
+        m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+        y = yearOfEra + era * 400 + (m <= 2);
+    }
+
+    // "2025.04.08" as unix seconds, UNKNOWN_TIME when the date is (partly) unknown
+    int64_t parseDate(std::string_view date)
+    {
+        if (date.size() != 10 || date[4] != '.' || date[7] != '.')
+            return GameLog::UNKNOWN_TIME;
+
+        int fields[3] = { 0, 0, 0 };
+        const int starts[3] = { 0, 5, 8 }, lengths[3] = { 4, 2, 2 };
+        for (int f = 0; f < 3; f++)
+            for (int i = starts[f]; i < starts[f] + lengths[f]; i++)
+            {
+                if (date[i] < '0' || date[i] > '9')
+                    return GameLog::UNKNOWN_TIME;
+                fields[f] = fields[f] * 10 + date[i] - '0';
+            }
+
+        if (fields[1] < 1 || fields[1] > 12 || fields[2] < 1 || fields[2] > 31)
+            return GameLog::UNKNOWN_TIME;
+        return daysFromCivil(fields[0], fields[1], fields[2]) * 86400;
+    }
+
+    // the PGN date of unix seconds, "????.??.??" when not known or not 4 digits
+    std::string formatDate(int64_t time)
+    {
+        if (time == GameLog::UNKNOWN_TIME)
+            return "????.??.??";
+
+        // days round down, so a time before 1970 is still on its own day
+        int64_t days = time / 86400 - (time % 86400 < 0);
+        int64_t y;
+        int m, d;
+        civilFromDays(days, y, m, d);
+        if (y < 0 || y > 9999)
+            return "????.??.??";
+
+        char date[16];
+        std::snprintf(date, sizeof(date), "%04d.%02d.%02d", static_cast<int>(y), m, d);
+        return date;
+    }
+
+    GameResult parseResult(std::string_view result)
+    {
+        if (result == "1-0") return GameResult::WHITE_WINS;
+        if (result == "0-1") return GameResult::BLACK_WINS;
+        if (result == "1/2-1/2") return GameResult::DRAW;
+        return GameResult::UNKNOWN;
+    }
+
+    uint64_t readKey(const uint8_t* p)
+    {
+        uint64_t key = 0;
+        for (int i = 3; i >= 0; i--)
+            key = (key << 16) | readLogWord(p + 2 * i);
+        return key;
+    }
+}
+
+
+GameResult gameResult(const Position& position)
+{
+    MoveList moves;
+    generateLegal(position, moves);
+
+    if (!moves.Empty())
+        return GameResult::UNKNOWN;
+    if (!position.InCheck())
+        return GameResult::DRAW;
+    return position.GetSideToMove() == WHITE ? GameResult::BLACK_WINS : GameResult::WHITE_WINS;
+}
+
+
+const char* resultToString(GameResult result)
+{
+    switch (result)
+    {
+    case GameResult::WHITE_WINS: return "1-0";
+    case GameResult::BLACK_WINS: return "0-1";
+    case GameResult::DRAW: return "1/2-1/2";
+    default: return "*";
+    }
+}
+
+
+bool GameRecord::Replay(Position& position, const std::function<void(const Position&, Move)>& callback) const
+{
+    if (fen.empty())
+        position.SetStartPosition();
+    else if (!position.SetFen(fen))
+        return false;
+
+    MoveList legal;
+    for (size_t i = 0; i < bodyWords; i++)
+    {
+        uint16_t word = readLogWord(body + 2 * i);
+
+        if (GameLog::IsMarker(word))
+        {
+            // a checkpoint cut off by the end of the log has nothing to check
+            if (i + 4 >= bodyWords)
+                break;
+            if (readKey(body + 2 * (i + 1)) != position.GetKey())
+                return false;
+            i += 4;
+            continue;
+        }
+
+        Move m = Move::FromRaw(word);
+        legal.Clear();
+        generateLegal(position, legal);
+        if (!legal.Contains(m))
+            return false;
+
+        position.MakeMove(m);
+        if (callback)
+            callback(position, m);
+    }
+
+    return true;
+}
+
+
+bool GameLogWriter::Open(const char* path, int interval)
+{
+    Close();
+    checkpointInterval = std::max(1, interval);
+
+    // never append to a file that is not a log, an existing log keeps its interval
+    if (std::FILE* existing = std::fopen(path, "rb"))
+    {
+        uint8_t header[GameLog::HEADER_SIZE];
+        size_t read = std::fread(header, 1, sizeof(header), existing);
+        std::fclose(existing);
+
+        if (read > 0 && (read < sizeof(header) || std::memcmp(header, GameLog::MAGIC, sizeof(GameLog::MAGIC))
+            || readLogWord(header + 4) != GameLog::VERSION))
+            return false;
+        if (read == sizeof(header))
+            checkpointInterval = std::max<int>(1, readLogWord(header + 6));
+    }
+
+    file = std::fopen(path, "ab");
+    if (!file)
+        return false;
+
+    std::fseek(file, 0, SEEK_END);
+    if (std::ftell(file) == 0)
+    {
+        std::fwrite(GameLog::MAGIC, 1, sizeof(GameLog::MAGIC), file);
+        Write(GameLog::VERSION);
+        Write(static_cast<uint16_t>(checkpointInterval));
+        Flush();
+    }
+
+    return true;
+}
+
+
+void GameLogWriter::Close()
+{
+    if (!file)
+        return;
+
+    if (inGame)
+        EndGame(GameResult::UNKNOWN);
+
+    Flush();
+    std::fclose(file);
+    file = nullptr;
+}
+
+
+void GameLogWriter::BeginGame(const Position& start, int64_t startTime)
+{
+    if (!file)
+        return;
+    if (inGame)
+        EndGame(GameResult::UNKNOWN);
+
+    char fen[Position::FEN_CAPACITY];
+    size_t length = start.WriteFen(fen);
+    bool custom = std::string_view(fen, length) != Position::START_FEN;
+
+    Write(GameLog::MarkerWord(GameLog::GAME_BEGIN, custom));
+    // 4 words, the same as a key
+    WriteKey(static_cast<uint64_t>(startTime));
+
+    if (custom)
+    {
+        Write(static_cast<uint16_t>(length));
+        // a zero byte pads an odd length to a whole word
+        for (size_t i = 0; i < length; i += 2)
+            Write(static_cast<uint16_t>(static_cast<uint8_t>(fen[i]) | (i + 1 < length ? static_cast<uint8_t>(fen[i + 1]) << 8 : 0)));
+    }
+
+    ply = 0;
+    inGame = true;
+}
+
+
+void GameLogWriter::AddMove(Move m, uint64_t key)
+{
+    if (!inGame)
+        return;
+
+    Write(m.Raw());
+    if (++ply % checkpointInterval == 0)
+    {
+        Write(GameLog::MarkerWord(GameLog::CHECKPOINT));
+        WriteKey(key);
+    }
+}
+
+
+void GameLogWriter::EndGame(GameResult result)
+{
+    if (!inGame)
+        return;
+
+    Write(GameLog::MarkerWord(GameLog::GAME_END, static_cast<int>(result)));
+    inGame = false;
+}
+
+
+void GameLogWriter::Flush()
+{
+    if (!file)
+        return;
+
+    std::fwrite(buffer, 1, used, file);
+    std::fflush(file);
+    used = 0;
+}
+
+
+void GameLogWriter::Write(uint16_t word)
+{
+    if (used + 2 > sizeof(buffer))
+    {
+        std::fwrite(buffer, 1, used, file);
+        used = 0;
+    }
+
+    buffer[used++] = static_cast<uint8_t>(word);
+    buffer[used++] = static_cast<uint8_t>(word >> 8);
+}
+
+
+void GameLogWriter::WriteKey(uint64_t key)
+{
+    for (int i = 0; i < 4; i++)
+        Write(static_cast<uint16_t>(key >> (16 * i)));
+}
+
+
+bool GameLogReader::Open(const char* path)
+{
+    if (!file.Open(path) || file.Size() < GameLog::HEADER_SIZE
+        || std::memcmp(file.Data(), GameLog::MAGIC, sizeof(GameLog::MAGIC)))
+    {
+        file.Close();
+        return false;
+    }
+
+    auto data = reinterpret_cast<const uint8_t*>(file.Data());
+    version = readLogWord(data + 4);
+    checkpointInterval = readLogWord(data + 6);
+    pos = GameLog::HEADER_SIZE;
+    return true;
+}
+
+
+bool GameLogReader::Next(GameRecord& game)
+{
+    auto data = reinterpret_cast<const uint8_t*>(file.Data());
+    // a word cut in half by a crash is not read
+    size_t size = file.Size() & ~size_t(1);
+
+    // the start time, 2 unsigned words before version 2
+    size_t timeWords = version < 2 ? 2 : 4;
+    if (pos + 2 + 2 * timeWords > size)
+        return false;
+
+    uint16_t word = readLogWord(data + pos);
+    if (!GameLog::IsMarker(word) || word >> 12 != GameLog::GAME_BEGIN)
+        return false;
+
+    game = GameRecord{};
+    game.offset = pos;
+    if (timeWords == 4)
+        game.startTime = static_cast<int64_t>(readKey(data + pos + 2));
+    else if (int64_t time = readLogWord(data + pos + 2) | static_cast<int64_t>(readLogWord(data + pos + 4)) << 16)
+        game.startTime = time;
+
+    size_t p = pos + 2 + 2 * timeWords;
+    if (word & 1)
+    {
+        size_t length = p + 2 <= size ? readLogWord(data + p) : size;
+        if (p + 2 + length > size)
+            return false;
+
+        game.fen = std::string_view(reinterpret_cast<const char*>(data + p + 2), length);
+        p += 2 + ((length + 1) & ~size_t(1));
+    }
+
+    // the body runs to its GAME_END, or to the next game or the end of the
+    // log when the game was never finished
+    size_t bodyStart = p;
+    game.body = data + bodyStart;
+
+    while (p < size)
+    {
+        word = readLogWord(data + p);
+        if (!GameLog::IsMarker(word))
+        {
+            game.moveCount++;
+            p += 2;
+        }
+        else if (word >> 12 == GameLog::CHECKPOINT)
+            p += 10;
+        else
+        {
+            if (word >> 12 == GameLog::GAME_END)
+            {
+                game.result = static_cast<GameResult>(word & 3);
+                game.finished = true;
+            }
+            break;
+        }
+    }
+
+    p = std::min(p, size);
+    game.bodyWords = (p - bodyStart) / 2;
+    pos = game.finished ? p + 2 : p;
+    return true;
+}
+
+
+long long gameLogToPgn(const char* logPath, std::ostream& out)
+{
+    GameLogReader reader;
+    if (!reader.Open(logPath))
+        return -1;
+
+    GameRecord game;
+    Position position;
+    MoveList legal;
+    long long count = 0;
+
+    while (reader.Next(game))
+    {
+        std::string date = formatDate(game.startTime);
+        const char* result = resultToString(game.result);
+        out << "[Event \"Classic Chess\"]\n[Site \"?\"]\n[Date \"" << date << "\"]\n[Round \"" << count + 1
+            << "\"]\n[White \"?\"]\n[Black \"?\"]\n[Result \"" << result << "\"]\n";
+        if (!game.fen.empty())
+            out << "[SetUp \"1\"]\n[FEN \"" << game.fen << "\"]\n";
+        out << "\n";
+
+        if (game.fen.empty())
+            position.SetStartPosition();
+        else
+            position.SetFen(game.fen);
+
+        std::string line;
+        bool damaged = false;
+        game.ForEachMove([&](Move m)
+        {
+            legal.Clear();
+            generateLegal(position, legal);
+            if (damaged || !legal.Contains(m))
+            {
+                damaged = true;
+                return;
+            }
+
+            std::string san;
+            if (position.GetSideToMove() == WHITE || line.empty())
+                san = std::to_string(position.GetFullmoveNumber()) + (position.GetSideToMove() == WHITE ? ". " : "... ");
+            san += moveToSan(position, m);
+            position.MakeMove(m);
+
+            if (line.size() + san.size() + 1 > 79)
+            {
+                out << line << "\n";
+                line.clear();
+            }
+            line += line.empty() ? san : " " + san;
+        });
+
+        if (damaged)
+            line += " {the log is damaged here}";
+        out << line << (line.empty() ? "" : " ") << result << "\n\n";
+        count++;
+    }
+
+    return count;
+}
+
+
+long long pgnToGameLog(const char* pgnPath, const char* logPath)
+{
+    GameLogWriter writer;
+    if (!writer.Open(logPath))
+        return -1;
+
+    long long count = 0;
+    GameResult result = GameResult::UNKNOWN;
+    PgnStats stats;
+
+    // one thread, the games have to reach the writer one after the other
+    bool read = readPgnFile(pgnPath, [&](const PgnGame& game, const Position& position, Move move)
+    {
+        if (move)
+        {
+            writer.AddMove(move, position.GetKey());
+            return;
+        }
+
+        writer.EndGame(result);
+        writer.BeginGame(position, parseDate(game.GetTag("Date")));
+        result = parseResult(game.GetTag("Result"));
+        count++;
+    }, 1, stats);
+
+    writer.EndGame(result);
+    writer.Close();
+    return read ? count : -1;
+}
@@ -0,0 +1,272 @@
+/*****************************************************************//**
+ * \file   gamelog.hpp
+ * \brief  Compact, append only binary log of played games
+ *
+ * After an 8 byte file header ("CGL1", the version and the checkpoint
+ * interval) the log is a stream of little endian 16-bit words. A word is
+ * either a move, in the Move encoding, or a marker. Markers use the codes
+ * no move can have, origin equal to destination: the flags field says
+ * which marker it is and the square field carries a small payload.
+ *
+ *  GAME_BEGIN   payload bit 0 set when a FEN follows. Then the start time
+ *               (signed unix seconds, 4 words, GameLog::UNKNOWN_TIME when
+ *               not known) and, with the bit, the FEN length and its
+ *               characters, padded to a whole word.
+ *  CHECKPOINT   every interval plies, the Zobrist key (4 words) of the
+ *               position reached, so a reader can check its replay at
+ *               any point of a game and look up positions by key without
+ *               replaying every game from the start.
+ *  GAME_END     the result in the payload.
+ *
+ * So a move is 2 bytes, a game of 80 plies with its header and checkpoints
+ * is under 200 bytes, and a game being played is written move by move: a
+ * log cut off mid game still reads back up to its last move.
+ *
+ * Version 1 logs stored the start time as 2 unsigned words, 0 when not
+ * known, which lost every date before 1970 or after 2106. They are still
+ * read, but never appended to.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_GAMELOG_HPP__
+#define __BYTENOL_CHESS_GAMELOG_HPP__
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <ostream>
+#include <string_view>
+
+#include "position.hpp"
+#include "mappedfile.hpp"
+
+
+enum class GameResult : uint8_t
+{
+    UNKNOWN,
+    WHITE_WINS,
+    BLACK_WINS,
+    DRAW
+};
+
+/**
+ * The result of a game that ended in the position, UNKNOWN while the side
+ * to move still has a legal move.
+ */
+GameResult gameResult(const Position& position);
+
+const char* resultToString(GameResult result);
+
+
+namespace GameLog
+{
+    constexpr char MAGIC[4] = { 'C', 'G', 'L', '1' };
+    constexpr uint16_t VERSION = 2;
+    constexpr size_t HEADER_SIZE = 8;
+    constexpr int DEFAULT_CHECKPOINT_INTERVAL = 32;
+    constexpr int64_t UNKNOWN_TIME = INT64_MIN;
+
+    enum Marker : uint16_t
+    {
+        GAME_BEGIN = 1,
+        CHECKPOINT = 2,
+        GAME_END = 3
+    };
+
+    constexpr uint16_t MarkerWord(Marker marker, int payload = 0)
+    {
+        return static_cast<uint16_t>(payload | (payload << 6) | (marker << 12));
+    }
+
+    constexpr bool IsMarker(uint16_t word)
+    {
+        return (word & 0x3F) == ((word >> 6) & 0x3F);
+    }
+}
+
+
+/**
+ * One game of a log, its moves are read straight from the mapped file.
+ */
+struct GameRecord
+{
+    // where the GAME_BEGIN marker is in the file, for GameLogReader::Seek()
+    size_t offset = 0;
+    // unix seconds, GameLog::UNKNOWN_TIME when not known
+    int64_t startTime = GameLog::UNKNOWN_TIME;
+    // empty when the game starts from the initial position
+    std::string_view fen;
+    GameResult result = GameResult::UNKNOWN;
+    // false when the log ends before the game does
+    bool finished = false;
+    int moveCount = 0;
+
+    // the move and checkpoint words after the header
+    const uint8_t* body = nullptr;
+    size_t bodyWords = 0;
+
+    /**
+     * Calls f(move) for every move in order.
+     */
+    template<typename F>
+    void ForEachMove(F&& f) const;
+
+    /**
+     * Sets up the start position and plays the moves on it, calling the
+     * callback (if any) after each one. False when a move is not legal or
+     * the position does not match a checkpoint, i.e the log is damaged.
+     */
+    bool Replay(Position& position, const std::function<void(const Position&, Move)>& callback = nullptr) const;
+};
+
+
+class GameLogWriter
+{
+public:
+    GameLogWriter() = default;
+
+    ~GameLogWriter()
+    {
+        Close();
+    }
+
+    GameLogWriter(const GameLogWriter&) = delete;
+    GameLogWriter& operator=(const GameLogWriter&) = delete;
+
+    /**
+     * Opens the log for appending and writes the file header to a new or
+     * empty file. False when the file cannot be written or is not a log of
+     * this version.
+     */
+    bool Open(const char* path, int checkpointInterval = GameLog::DEFAULT_CHECKPOINT_INTERVAL);
+
+    /**
+     * Ends a game left open with an unknown result and closes the file.
+     */
+    void Close();
+
+    inline bool IsOpen() const
+    {
+        return file != nullptr;
+    }
+
+    inline bool InGame() const
+    {
+        return inGame;
+    }
+
+    /**
+     * Starts a game from the position, its FEN is only stored when it is
+     * not the initial position. A game still open is ended first.
+     */
+    void BeginGame(const Position& start, int64_t startTime = std::time(nullptr));
+
+    /**
+     * Appends a move, key is the Zobrist key of the position after it.
+     */
+    void AddMove(Move m, uint64_t key);
+
+    void EndGame(GameResult result);
+
+    /**
+     * Hands the buffered words to the OS, e.g after every move of a game
+     * being played so a crash loses nothing.
+     */
+    void Flush();
+
+private:
+    std::FILE* file = nullptr;
+    int checkpointInterval = GameLog::DEFAULT_CHECKPOINT_INTERVAL;
+    int ply = 0;
+    bool inGame = false;
+
+    uint8_t buffer[4096];
+    size_t used = 0;
+
+    void Write(uint16_t word);
+
+    void WriteKey(uint64_t key);
+};
+
+
+/**
+ * Reads the games of a log one after the other. The file is memory
+ * mapped, so only the pages being read are loaded.
+ */
+class GameLogReader
+{
+public:
+    /**
+     * False when the file cannot be mapped or does not start with a log header.
+     */
+    bool Open(const char* path);
+
+    inline int GetCheckpointInterval() const
+    {
+        return checkpointInterval;
+    }
+
+    inline size_t Size() const
+    {
+        return file.Size();
+    }
+
+    /**
+     * The next game, false at the end of the log or when the data there is
+     * not a game (the rest of the log is unreadable then).
+     */
+    bool Next(GameRecord& game);
+
+    /**
+     * Continues at a game offset from an earlier GameRecord, or the first game.
+     */
+    inline void Seek(size_t offset)
+    {
+        pos = std::max(offset, GameLog::HEADER_SIZE);
+    }
+
+private:
+    MappedFile file;
+    size_t pos = 0;
+    int version = GameLog::VERSION;
+    int checkpointInterval = GameLog::DEFAULT_CHECKPOINT_INTERVAL;
+};
+
+
+/**
+ * Every game of the log as PGN, with the moves in SAN. Returns the
+ * number of games written, -1 when the log cannot be read.
+ */
+long long gameLogToPgn(const char* logPath, std::ostream& out);
+
+/**
+ * Appends every game of the PGN file to the log. Returns the number of
+ * games written, -1 when either file cannot be opened. The log only keeps
+ * the moves, the start position, the date and the result: every other tag
+ * (Event, Site, White, Black...) is dropped, so going back to PGN is lossy.
+ */
+long long pgnToGameLog(const char* pgnPath, const char* logPath);
+
+
+inline uint16_t readLogWord(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+
+template<typename F>
+void GameRecord::ForEachMove(F&& f) const
+{
+    for (size_t i = 0; i < bodyWords; i++)
+    {
+        uint16_t word = readLogWord(body + 2 * i);
+        if (!GameLog::IsMarker(word))
+            f(Move::FromRaw(word));
+        // a checkpoint is the only marker inside a game body
+        else
+            i += 4;
+    }
+}
+
+#endif
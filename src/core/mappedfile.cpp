@@ -0,0 +1,127 @@
+/*****************************************************************//**
+ * \file   mappedfile.cpp
+ * \brief  Read only memory mapped file
+ *********************************************************************/
+
+#include "mappedfile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(handle, &length))
+    {
+        CloseHandle(handle);
+        return false;
+    }
+
+    file = handle;
+    size = static_cast<size_t>(length.QuadPart);
+    open = true;
+
+    // a mapping of an empty file cannot be created
+    if (size == 0)
+        return true;
+
+    mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping)
+        data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!data)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void MappedFile::Close()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file)
+        CloseHandle(file);
+
+    data = nullptr;
+    mapping = file = nullptr;
+    size = 0;
+    open = false;
+}
+
+#else
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    open = true;
+
+    // mmap refuses a length of 0
+    if (size > 0)
+    {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED)
+        {
+            ::close(fd);
+            size = 0;
+            open = false;
+            return false;
+        }
+
+        // read front to back, let the kernel read ahead
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapped);
+    }
+
+    // the mapping keeps the file alive
+    ::close(fd);
+    return true;
+}
+
+
+void MappedFile::Close()
+{
+    if (data)
+        munmap(const_cast<char*>(data), size);
+
+    data = nullptr;
+    size = 0;
+    open = false;
+}
+
+#endif
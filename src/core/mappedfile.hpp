@@ -0,0 +1,74 @@
+/*****************************************************************//**
+ * \file   mappedfile.hpp
+ * \brief  Read only memory mapped file
+ *
+ * The whole file is mapped at once and handed out as a string_view, so
+ * readers can tokenize it in place and the OS pages it in on demand.
+ * An empty file opens fine and maps to an empty view.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_MAPPEDFILE_HPP__
+#define __BYTENOL_CHESS_MAPPEDFILE_HPP__
+
+#include <string_view>
+#include <cstddef>
+
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const char* path)
+    {
+        Open(path);
+    }
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Maps the file, closing the one mapped before. False when the file
+     * cannot be opened or mapped.
+     */
+    bool Open(const char* path);
+
+    void Close();
+
+    inline bool IsOpen() const
+    {
+        return open;
+    }
+
+    inline const char* Data() const
+    {
+        return data;
+    }
+
+    inline size_t Size() const
+    {
+        return size;
+    }
+
+    inline std::string_view View() const
+    {
+        return { data, size };
+    }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool open = false;
+
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+#endif
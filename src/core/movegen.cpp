@@ -0,0 +1,239 @@
+/*****************************************************************//**
+ * \file   movegen.cpp
+ * \brief  Whole position move generation
+ *
+ * The generators are templated on the side to move, so pawn directions,
+ * start and promotion rows are constants and the pawns move set-wise with
+ * shifts. The color is looked at once, in the public entry points.
+ *
+ * Legal generation works out the checkers and pinned pieces first. In
+ * check, every piece but the king may only land on the checking piece or
+ * between it and the king (nothing, in double check). Afterwards only the
+ * king moves, pinned pieces and en passant need a closer look, nothing is
+ * ever played on the board.
+ *********************************************************************/
+
+#include "movegen.hpp"
+
+namespace
+{
+    enum GenType
+    {
+        ALL,
+        CAPTURES
+    };
+
+    inline void addTargets(MoveList& list, int from, Bitboard targets, Bitboard enemies)
+    {
+        while (targets)
+        {
+            int to = PopLsb(targets);
+            list.Add(Move(from, to, TestBit(enemies, to) ? Move::CAPTURE : Move::QUIET));
+        }
+    }
+
+    // every destination in the set, coming from the square Offset behind it
+    template<int Offset>
+    inline void addShifted(MoveList& list, Bitboard targets, int flags)
+    {
+        while (targets)
+        {
+            int to = PopLsb(targets);
+            list.Add(Move(to - Offset, to, flags));
+        }
+    }
+
+    template<int Offset>
+    inline void addPromotions(MoveList& list, Bitboard targets, bool capture, bool queenOnly)
+    {
+        int flags = capture ? Move::PROMO_KNIGHT_CAPTURE : Move::PROMO_KNIGHT;
+        while (targets)
+        {
+            int to = PopLsb(targets);
+            if (queenOnly)
+                list.Add(Move(to - Offset, to, flags + 3));
+            else
+                for (int i = 0; i < 4; i++)
+                    list.Add(Move(to - Offset, to, flags + i));
+        }
+    }
+
+    // target holds the squares the pieces other than the king may land on
+    template<Color Us, GenType Type>
+    void generatePawnMoves(const Position& position, MoveList& list, Bitboard enemies, Bitboard empty, Bitboard target)
+    {
+        constexpr int UP = PAWN_UP<Us>;
+        constexpr int UP_LEFT = PAWN_UP_LEFT<Us>;
+        constexpr int UP_RIGHT = PAWN_UP_RIGHT<Us>;
+        // pawns one step from promoting, and where a single push lands to allow a double one
+        constexpr Bitboard PROMOTING = RowBB(PAWN_LAST_ROW<Us> - UP / 8);
+        constexpr Bitboard DOUBLE_PUSH_ROW = RowBB(PAWN_START_ROW<Us> + UP / 8);
+
+        Bitboard pawns = position.GetPieces(Us, CharacterName::PAWN);
+        Bitboard promoting = pawns & PROMOTING;
+        pawns &= ~PROMOTING;
+        enemies &= target;
+
+        if constexpr (Type == ALL)
+        {
+            Bitboard single = Shift<UP>(pawns) & empty;
+            Bitboard twice = Shift<UP>(single & DOUBLE_PUSH_ROW) & empty;
+            addShifted<UP>(list, single & target, Move::QUIET);
+            addShifted<UP + UP>(list, twice & target, Move::DOUBLE_PUSH);
+        }
+
+        addShifted<UP_LEFT>(list, Shift<UP_LEFT>(pawns) & enemies, Move::CAPTURE);
+        addShifted<UP_RIGHT>(list, Shift<UP_RIGHT>(pawns) & enemies, Move::CAPTURE);
+
+        if (promoting)
+        {
+            // a queen promotion changes the material like a capture does
+            addPromotions<UP>(list, Shift<UP>(promoting) & empty & target, false, Type == CAPTURES);
+            addPromotions<UP_LEFT>(list, Shift<UP_LEFT>(promoting) & enemies, true, false);
+            addPromotions<UP_RIGHT>(list, Shift<UP_RIGHT>(promoting) & enemies, true, false);
+        }
+
+        // in check, taking the pawn that just moved can be the evasion itself
+        int ep = position.GetEnPassantSquare();
+        if (ep >= 0 && (TestBit(target, ep) || TestBit(target, ep - UP)))
+        {
+            // the capturers stand where a pawn of the other color would attack from the square
+            Bitboard capturers = Attacks::PAWN[Us ^ 1][ep] & pawns;
+            while (capturers)
+                list.Add(Move(PopLsb(capturers), ep, Move::EN_PASSANT));
+        }
+    }
+
+    template<Color Us, GenType Type>
+    void generate(const Position& position, MoveList& list, Bitboard target)
+    {
+        constexpr Color Them = Color(Us ^ 1);
+
+        Bitboard own = position.GetColorPieces(Us);
+        Bitboard enemies = position.GetColorPieces(Them);
+        Bitboard occupied = position.GetOccupied();
+        Bitboard kingAllowed = Type == CAPTURES ? enemies : ~own;
+        Bitboard allowed = kingAllowed & target;
+
+        generatePawnMoves<Us, Type>(position, list, enemies, ~occupied, target);
+
+        Bitboard b = position.GetPieces(Us, CharacterName::KNIGHT);
+        while (b)
+        {
+            int from = PopLsb(b);
+            addTargets(list, from, Attacks::Knight(from) & allowed, enemies);
+        }
+
+        b = position.GetPieces(Us, CharacterName::BISHOP);
+        while (b)
+        {
+            int from = PopLsb(b);
+            addTargets(list, from, Attacks::Bishop(from, occupied) & allowed, enemies);
+        }
+
+        b = position.GetPieces(Us, CharacterName::ROOK);
+        while (b)
+        {
+            int from = PopLsb(b);
+            addTargets(list, from, Attacks::Rook(from, occupied) & allowed, enemies);
+        }
+
+        b = position.GetPieces(Us, CharacterName::QUEEN);
+        while (b)
+        {
+            int from = PopLsb(b);
+            addTargets(list, from, Attacks::Queen(from, occupied) & allowed, enemies);
+        }
+
+        int king = position.GetKingSquare(Us);
+        addTargets(list, king, Attacks::King(king) & kingAllowed, enemies);
+
+        if (Type == ALL && position.GetCastlingRights())
+        {
+            if (position.CanCastle<Us>(true))
+                list.Add(Move(king, Position::CastleDestination(Us, true), Move::KING_CASTLE));
+            if (position.CanCastle<Us>(false))
+                list.Add(Move(king, Position::CastleDestination(Us, false), Move::QUEEN_CASTLE));
+        }
+    }
+
+    template<Color Us, GenType Type>
+    void generateLegal(const Position& position, MoveList& list)
+    {
+        constexpr Color Them = Color(Us ^ 1);
+
+        int king = position.GetKingSquare(Us);
+        Bitboard checkers = position.GetCheckers();
+        Bitboard target = ~Bitboard(0);
+
+        if (checkers)
+            target = PopCount(checkers) > 1 ? 0 : Attacks::Between(king, Lsb(checkers)) | checkers;
+
+        MoveList moves;
+        generate<Us, Type>(position, moves, target);
+
+        Bitboard pinned = position.GetPinned<Us>();
+        Bitboard enemies = position.GetColorPieces(Them);
+        Bitboard rooks = enemies & (position.GetPieces(CharacterName::ROOK) | position.GetPieces(CharacterName::QUEEN));
+        Bitboard bishops = enemies & (position.GetPieces(CharacterName::BISHOP) | position.GetPieces(CharacterName::QUEEN));
+        // without the king, so it cannot hide behind itself from a slider
+        Bitboard occupied = position.GetOccupied() ^ SquareBB(king);
+
+        for (auto m : moves)
+        {
+            int from = m.From(), to = m.To();
+
+            if (from == king)
+            {
+                // castling already checked the squares the king crosses
+                if (m.IsCastle() || !(position.AttackersTo(to, occupied) & enemies))
+                    list.Add(m);
+            }
+            else if (m.Flags() == Move::EN_PASSANT)
+            {
+                // two pawns leave the row at once, which can open a line onto the king
+                Bitboard after = (occupied ^ SquareBB(from) ^ SquareBB(to - PAWN_UP<Us>) ^ SquareBB(to)) | SquareBB(king);
+                if (!(Attacks::Rook(king, after) & rooks) && !(Attacks::Bishop(king, after) & bishops))
+                    list.Add(m);
+            }
+            else if (!TestBit(pinned, from) || TestBit(Attacks::Line(king, from), to))
+                list.Add(m);
+        }
+    }
+}
+
+
+void generatePseudoLegal(const Position& position, MoveList& list)
+{
+    if (position.GetSideToMove() == WHITE)
+        generate<WHITE, ALL>(position, list, ~Bitboard(0));
+    else
+        generate<BLACK, ALL>(position, list, ~Bitboard(0));
+}
+
+
+void generateCaptures(const Position& position, MoveList& list)
+{
+    if (position.GetSideToMove() == WHITE)
+        generate<WHITE, CAPTURES>(position, list, ~Bitboard(0));
+    else
+        generate<BLACK, CAPTURES>(position, list, ~Bitboard(0));
+}
+
+
+void generateLegal(const Position& position, MoveList& list)
+{
+    if (position.GetSideToMove() == WHITE)
+        generateLegal<WHITE, ALL>(position, list);
+    else
+        generateLegal<BLACK, ALL>(position, list);
+}
+
+
+void generateLegalCaptures(const Position& position, MoveList& list)
+{
+    if (position.GetSideToMove() == WHITE)
+        generateLegal<WHITE, CAPTURES>(position, list);
+    else
+        generateLegal<BLACK, CAPTURES>(position, list);
+}
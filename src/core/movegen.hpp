@@ -0,0 +1,37 @@
+/*****************************************************************//**
+ * \file   movegen.hpp
+ * \brief  Whole position move generation
+ *
+ * generatePseudoLegal() lists every move the pieces of the side to move
+ * can make, including castling, en passant and all four promotions, but
+ * may leave the own king in check. generateLegal() only lists the legal ones.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_MOVEGEN_HPP__
+#define __BYTENOL_CHESS_MOVEGEN_HPP__
+
+#include "position.hpp"
+#include "movelist.hpp"
+
+
+void generatePseudoLegal(const Position& position, MoveList& list);
+
+/**
+ * The pseudo legal captures, en passant and queen promotions, for the
+ * quiescence search.
+ */
+void generateCaptures(const Position& position, MoveList& list);
+
+/**
+ * Only the moves that do not leave the mover's king attacked, worked out
+ * from the checkers and pinned pieces without playing any move.
+ */
+void generateLegal(const Position& position, MoveList& list);
+
+/**
+ * The legal subset of generateCaptures(). In check it only has the
+ * evasions that capture, use generateLegal() for all of them.
+ */
+void generateLegalCaptures(const Position& position, MoveList& list);
+
+#endif
@@ -0,0 +1,81 @@
+/*****************************************************************//**
+ * \file   movelist.hpp
+ * \brief  Fixed capacity move container
+ *
+ * Lives on the stack, so generating moves never touches the heap.
+ * 256 is above the largest number of moves any chess position allows.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_MOVELIST_HPP__
+#define __BYTENOL_CHESS_MOVELIST_HPP__
+
+#include <cstddef>
+
+#include "types.hpp"
+
+
+class MoveList
+{
+public:
+    static constexpr size_t CAPACITY = 256;
+
+    inline void Add(Move m)
+    {
+        moves[count++] = m;
+    }
+
+    inline void Clear()
+    {
+        count = 0;
+    }
+
+    inline size_t Size() const
+    {
+        return count;
+    }
+
+    inline bool Empty() const
+    {
+        return count == 0;
+    }
+
+    inline Move operator[](size_t i) const
+    {
+        return moves[i];
+    }
+
+    inline Move& operator[](size_t i)
+    {
+        return moves[i];
+    }
+
+    inline Move* begin() { return moves; }
+    inline Move* end() { return moves + count; }
+    inline const Move* begin() const { return moves; }
+    inline const Move* end() const { return moves + count; }
+
+    /**
+     * First move landing on the square, or a null move.
+     */
+    inline Move FindTo(int to) const
+    {
+        for (size_t i = 0; i < count; i++)
+            if (moves[i].To() == to)
+                return moves[i];
+        return Move{};
+    }
+
+    inline bool Contains(Move m) const
+    {
+        for (size_t i = 0; i < count; i++)
+            if (moves[i] == m)
+                return true;
+        return false;
+    }
+
+private:
+    Move moves[CAPACITY];
+    size_t count = 0;
+};
+
+#endif
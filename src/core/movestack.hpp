@@ -0,0 +1,118 @@
+/*****************************************************************//**
+ * \file   movestack.hpp
+ * \brief  Moves of a game with a cursor, for stepping back and forth
+ *
+ * The position keeps what it needs to take a move back on its own undo
+ * stack (captured piece, castling rights, en passant square, key), so
+ * going one ply back or forward is a single UnmakeMove() or MakeMove()
+ * however long the game is. Moves taken back stay above the cursor until
+ * a different move is played.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_MOVESTACK_HPP__
+#define __BYTENOL_CHESS_MOVESTACK_HPP__
+
+#include <cstddef>
+#include <vector>
+
+#include "position.hpp"
+
+
+class MoveStack
+{
+public:
+    /**
+     * Works on the position as it is now, which becomes ply 0.
+     */
+    explicit MoveStack(Position& _position) : position(_position)
+    {
+        moves.reserve(Position::MAX_HISTORY);
+    }
+
+    /**
+     * Forgets every move, the position as it is now becomes ply 0.
+     */
+    inline void Clear()
+    {
+        moves.clear();
+        ply = 0;
+    }
+
+    /**
+     * Plays a move at the cursor, the moves taken back above it are dropped.
+     */
+    inline void Push(Move m)
+    {
+        moves.resize(ply);
+        moves.push_back(m);
+        position.MakeMove(m);
+        ply++;
+    }
+
+    inline bool CanUndo() const
+    {
+        return ply > 0;
+    }
+
+    inline bool CanRedo() const
+    {
+        return ply < moves.size();
+    }
+
+    inline bool Undo()
+    {
+        if (!CanUndo())
+            return false;
+
+        position.UnmakeMove();
+        ply--;
+        return true;
+    }
+
+    inline bool Redo()
+    {
+        if (!CanRedo())
+            return false;
+
+        position.MakeMove(moves[ply++]);
+        return true;
+    }
+
+    /**
+     * Steps back or forward to the ply, clamped to the moves known.
+     */
+    inline void Seek(size_t target)
+    {
+        while (ply > target && Undo());
+        while (ply < target && Redo());
+    }
+
+    // moves played before the cursor
+    inline size_t GetPly() const
+    {
+        return ply;
+    }
+
+    // every move known, the ones taken back included
+    inline size_t Size() const
+    {
+        return moves.size();
+    }
+
+    inline Move operator[](size_t i) const
+    {
+        return moves[i];
+    }
+
+    inline const Position& GetPosition() const
+    {
+        return position;
+    }
+
+private:
+    Position& position;
+    std::vector<Move> moves;
+    size_t ply = 0;
+};
+
+#endif
@@ -0,0 +1,32 @@
+/*****************************************************************//**
+ * \file   notation.cpp
+ * \brief  Text forms of squares and moves
+ *********************************************************************/
+
+#include "notation.hpp"
+
+
+std::string squareToString(int sq)
+{
+    return { static_cast<char>('a' + SquareX(sq)), static_cast<char>('8' - SquareY(sq)) };
+}
+
+
+int parseSquare(const char* text)
+{
+    if (text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8')
+        return -1;
+    return MakeSquare(text[0] - 'a', '8' - text[1]);
+}
+
+
+std::string moveToString(Move m)
+{
+    if (!m)
+        return "0000";
+
+    auto s = squareToString(m.From()) + squareToString(m.To());
+    if (m.IsPromotion())
+        s += "nbrq"[m.Flags() & 3];
+    return s;
+}
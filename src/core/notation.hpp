@@ -0,0 +1,28 @@
+/*****************************************************************//**
+ * \file   notation.hpp
+ * \brief  Text forms of squares and moves
+ *
+ * Squares use algebraic names, row 0 is the 8th rank since white plays
+ * up the board. Moves are written as origin and destination squares plus
+ * the promotion letter, e.g "e2e4" or "e7e8q".
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_NOTATION_HPP__
+#define __BYTENOL_CHESS_NOTATION_HPP__
+
+#include <string>
+
+#include "bitboard.hpp"
+#include "types.hpp"
+
+
+std::string squareToString(int sq);
+
+/**
+ * Parses "e4" style names, returns -1 when the text is not a square.
+ */
+int parseSquare(const char* text);
+
+std::string moveToString(Move m);
+
+#endif
@@ -0,0 +1,433 @@
+/*****************************************************************//**
+ * \file   pgn.cpp
+ * \brief  Standard algebraic notation and a bulk PGN reader
+ *********************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "pgn.hpp"
+#include "mappedfile.hpp"
+#include "notation.hpp"
+
+namespace
+{
+    // SAN letters by CharacterName, pawns have none
+    constexpr char PIECE_LETTERS[] = "  RNBKQ";
+
+    constexpr CharacterName letterToName(char c)
+    {
+        switch (c)
+        {
+        case 'R': return CharacterName::ROOK;
+        case 'N': return CharacterName::KNIGHT;
+        case 'B': return CharacterName::BISHOP;
+        case 'K': return CharacterName::KING;
+        case 'Q': return CharacterName::QUEEN;
+        default: return CharacterName::NONE;
+        }
+    }
+
+    constexpr bool isSpace(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+    }
+
+    // characters that end a move token without a space in between
+    constexpr bool isDelimiter(char c)
+    {
+        return isSpace(c) || c == '{' || c == '}' || c == '(' || c == ')' || c == ';';
+    }
+
+    inline bool isResult(std::string_view token)
+    {
+        return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+    }
+
+    // the position just past the end of the line
+    inline size_t skipLine(std::string_view text, size_t pos)
+    {
+        size_t end = text.find('\n', pos);
+        return end == std::string_view::npos ? text.size() : end + 1;
+    }
+
+    inline size_t skipComment(std::string_view text, size_t pos)
+    {
+        size_t end = text.find('}', pos);
+        return end == std::string_view::npos ? text.size() : end + 1;
+    }
+
+    // pos is on the opening parenthesis, variations may nest and hold comments
+    size_t skipVariation(std::string_view text, size_t pos)
+    {
+        int depth = 0;
+        while (pos < text.size())
+        {
+            char c = text[pos++];
+            if (c == '(')
+                depth++;
+            else if (c == ')' && --depth == 0)
+                break;
+            else if (c == '{')
+                pos = skipComment(text, pos);
+            else if (c == ';')
+                pos = skipLine(text, pos);
+        }
+        return pos;
+    }
+
+    /**
+     * The first game starting at or after pos: a '[' opening a line that
+     * follows a blank one. Only used to cut chunks, the games inside a
+     * chunk are told apart by their results and tags.
+     */
+    size_t findGameStart(std::string_view text, size_t pos)
+    {
+        while ((pos = text.find('[', pos)) != std::string_view::npos)
+        {
+            if (pos == 0)
+                return 0;
+
+            if (text[pos - 1] == '\n')
+            {
+                size_t back = pos - 1;
+                while (back > 0 && (text[back - 1] == ' ' || text[back - 1] == '\t' || text[back - 1] == '\r'))
+                    back--;
+                if (back == 0 || text[back - 1] == '\n')
+                    return pos;
+            }
+            pos++;
+        }
+        return text.size();
+    }
+
+    /**
+     * Reads the games of a chunk that starts at a game. base is where the
+     * chunk starts in the whole text, for the game offsets.
+     */
+    void readChunk(std::string_view chunk, size_t base, Position& position, const PgnCallback& callback, PgnStats& stats)
+    {
+        size_t pos = 0;
+        size_t size = chunk.size();
+
+        while (true)
+        {
+            while (pos < size && isSpace(chunk[pos]))
+                pos++;
+            if (pos >= size)
+                break;
+
+            // tag pairs, one per line
+            size_t start = pos, tagsEnd = pos;
+            while (pos < size && chunk[pos] == '[')
+            {
+                pos = tagsEnd = skipLine(chunk, pos);
+                while (pos < size && isSpace(chunk[pos]))
+                    pos++;
+            }
+
+            PgnGame game{ chunk.substr(start, tagsEnd - start), base + start };
+            auto fen = game.GetTag("FEN");
+            bool failed = false;
+
+            if (fen.empty())
+                position.SetStartPosition();
+            else
+                failed = !position.SetFen(fen);
+
+            stats.games++;
+            if (!failed)
+            {
+                callback(game, position, Move{});
+                stats.positions++;
+            }
+
+            while (pos < size)
+            {
+                char c = chunk[pos];
+
+                if (isSpace(c))
+                    pos++;
+                // a tag line without a result before it starts the next game
+                else if (c == '[' && (pos == 0 || chunk[pos - 1] == '\n'))
+                    break;
+                else if (c == '{')
+                    pos = skipComment(chunk, pos + 1);
+                else if (c == ';' || (c == '%' && (pos == 0 || chunk[pos - 1] == '\n')))
+                    pos = skipLine(chunk, pos);
+                else if (c == '(')
+                    pos = skipVariation(chunk, pos);
+                else if (c == ')' || c == '}')
+                    pos++;
+                else
+                {
+                    size_t tokenStart = pos;
+                    while (pos < size && !isDelimiter(chunk[pos]))
+                        pos++;
+                    auto token = chunk.substr(tokenStart, pos - tokenStart);
+
+                    if (isResult(token))
+                        break;
+                    if (token[0] == '$' || failed)
+                        continue;
+
+                    // move numbers, "12." or "12...", may be glued to the move
+                    size_t digits = 0;
+                    while (digits < token.size() && token[digits] >= '0' && token[digits] <= '9')
+                        digits++;
+                    if (digits < token.size() && token[digits] == '.')
+                        token.remove_prefix(digits);
+                    while (!token.empty() && token[0] == '.')
+                        token.remove_prefix(1);
+                    if (token.empty())
+                        continue;
+
+                    Move m = parseSan(position, token);
+                    if (!m)
+                    {
+                        failed = true;
+                        continue;
+                    }
+
+                    position.MakeMove(m);
+                    callback(game, position, m);
+                    stats.positions++;
+                }
+            }
+
+            stats.errors += failed;
+        }
+    }
+}
+
+
+Move parseSan(const Position& position, std::string_view san)
+{
+    // check, mate and annotation marks say nothing about the move itself
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?'))
+        san.remove_suffix(1);
+
+    MoveList moves;
+    generateLegal(position, moves);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+    {
+        int flags = san.size() == 3 ? Move::KING_CASTLE : Move::QUEEN_CASTLE;
+        for (auto m : moves)
+            if (m.Flags() == flags)
+                return m;
+        return Move{};
+    }
+
+    auto name = CharacterName::PAWN;
+    if (!san.empty() && letterToName(san[0]) != CharacterName::NONE)
+    {
+        name = letterToName(san[0]);
+        san.remove_prefix(1);
+    }
+
+    // "e8=Q", and "e8Q" as some writers leave out the '='
+    auto promotion = CharacterName::NONE;
+    if (name == CharacterName::PAWN && san.size() > 2 && letterToName(san.back()) != CharacterName::NONE)
+    {
+        promotion = letterToName(san.back());
+        san.remove_suffix(1);
+        if (san.back() == '=')
+            san.remove_suffix(1);
+    }
+
+    if (san.size() < 2)
+        return Move{};
+
+    int to = parseSquare(san.data() + san.size() - 2);
+    if (to < 0)
+        return Move{};
+    san.remove_suffix(2);
+
+    // what is left disambiguates by file, rank or both
+    int fromX = -1, fromY = -1;
+    for (char c : san)
+    {
+        if (c >= 'a' && c <= 'h')
+            fromX = c - 'a';
+        else if (c >= '1' && c <= '8')
+            fromY = '8' - c;
+        else if (c != 'x' && c != ':' && c != '-')
+            return Move{};
+    }
+
+    // a pawn only leaves its file when the SAN names it, as in "exd5"
+    if (name == CharacterName::PAWN && fromX < 0)
+        fromX = SquareX(to);
+
+    Move found{};
+    for (auto m : moves)
+    {
+        int from = m.From();
+        if (m.To() != to || position.GetNameAt(from) != name
+            || (fromX >= 0 && SquareX(from) != fromX) || (fromY >= 0 && SquareY(from) != fromY))
+            continue;
+        if (m.IsPromotion() ? m.GetPromotion() != promotion : promotion != CharacterName::NONE)
+            continue;
+
+        // more than one piece fits
+        if (found)
+            return Move{};
+        found = m;
+    }
+
+    return found;
+}
+
+
+std::string moveToSan(Position& position, Move m)
+{
+    std::string san;
+    int from = m.From(), to = m.To();
+    auto name = position.GetNameAt(from);
+
+    if (m.IsCastle())
+        san = m.Flags() == Move::KING_CASTLE ? "O-O" : "O-O-O";
+    else
+    {
+        if (name != CharacterName::PAWN)
+        {
+            san += PIECE_LETTERS[static_cast<int>(name)];
+
+            // other pieces of the same kind that could go to the square
+            MoveList moves;
+            generateLegal(position, moves);
+
+            bool ambiguous = false, sameFile = false, sameRow = false;
+            for (auto other : moves)
+            {
+                int otherFrom = other.From();
+                if (other.To() != to || otherFrom == from || position.GetNameAt(otherFrom) != name)
+                    continue;
+
+                ambiguous = true;
+                sameFile |= SquareX(otherFrom) == SquareX(from);
+                sameRow |= SquareY(otherFrom) == SquareY(from);
+            }
+
+            if (ambiguous && (!sameFile || sameRow))
+                san += static_cast<char>('a' + SquareX(from));
+            if (ambiguous && sameFile)
+                san += static_cast<char>('8' - SquareY(from));
+        }
+        else if (m.IsCapture())
+            san += static_cast<char>('a' + SquareX(from));
+
+        if (m.IsCapture())
+            san += 'x';
+        san += squareToString(to);
+
+        if (m.IsPromotion())
+        {
+            san += '=';
+            san += PIECE_LETTERS[static_cast<int>(m.GetPromotion())];
+        }
+    }
+
+    position.MakeMove(m);
+    if (position.InCheck())
+    {
+        MoveList replies;
+        generateLegal(position, replies);
+        san += replies.Empty() ? '#' : '+';
+    }
+    position.UnmakeMove();
+
+    return san;
+}
+
+
+std::string_view PgnGame::GetTag(std::string_view name) const
+{
+    size_t pos = 0;
+    while ((pos = tags.find('[', pos)) != std::string_view::npos)
+    {
+        size_t nameStart = pos + 1;
+        size_t nameEnd = tags.find_first_of(" \t\"]", nameStart);
+        if (nameEnd == std::string_view::npos)
+            break;
+
+        size_t open = tags.find('"', nameEnd);
+        if (open == std::string_view::npos)
+            break;
+
+        // the value ends at the first quote that is not escaped
+        size_t close = open + 1;
+        while (close < tags.size() && tags[close] != '"')
+            close += tags[close] == '\\' ? 2 : 1;
+        if (close >= tags.size())
+            break;
+
+        if (tags.substr(nameStart, nameEnd - nameStart) == name)
+            return tags.substr(open + 1, close - open - 1);
+        pos = close + 1;
+    }
+
+    return {};
+}
+
+
+PgnStats readPgn(std::string_view text, const PgnCallback& callback, int threads)
+{
+    threads = std::max(1, threads);
+
+    // a few chunks of at least a megabyte per thread, so one chunk of long
+    // games does not leave the other threads waiting
+    constexpr size_t MIN_CHUNK_SIZE = size_t(1) << 20;
+    size_t chunkCount = threads == 1 ? 1 : std::clamp<size_t>(text.size() / MIN_CHUNK_SIZE, 1, static_cast<size_t>(threads) * 8);
+
+    std::vector<size_t> bounds = { 0 };
+    for (size_t i = 1; i < chunkCount; i++)
+        bounds.push_back(findGameStart(text, std::max(i * text.size() / chunkCount, bounds.back())));
+    bounds.push_back(text.size());
+
+    std::atomic<size_t> nextChunk{ 0 };
+    std::vector<PgnStats> results(threads);
+
+    auto work = [&](int index)
+    {
+        Position position;
+        PgnStats stats;
+
+        for (size_t c; (c = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunkCount;)
+            readChunk(text.substr(bounds[c], bounds[c + 1] - bounds[c]), bounds[c], position, callback, stats);
+
+        results[index] = stats;
+    };
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threads; i++)
+        helpers.emplace_back(work, i);
+    work(0);
+    for (auto& helper : helpers)
+        helper.join();
+
+    PgnStats total;
+    for (const auto& stats : results)
+    {
+        total.games += stats.games;
+        total.positions += stats.positions;
+        total.errors += stats.errors;
+    }
+    total.bytes = text.size();
+
+    return total;
+}
+
+
+bool readPgnFile(const char* path, const PgnCallback& callback, int threads, PgnStats& stats)
+{
+    MappedFile file;
+    if (!file.Open(path))
+        return false;
+
+    stats = readPgn(file.View(), callback, threads);
+    return true;
+}
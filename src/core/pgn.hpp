@@ -0,0 +1,85 @@
+/*****************************************************************//**
+ * \file   pgn.hpp
+ * \brief  Standard algebraic notation and a bulk PGN reader
+ *
+ * The reader tokenizes the PGN text in place, tags and moves are views
+ * into it and nothing is copied or allocated per game. Every SAN move is
+ * resolved against the legal moves of the position it is played in and
+ * each position along the game is handed to a callback.
+ *
+ * Large inputs are cut into chunks at game starts (a tag line following a
+ * blank line) and the chunks are read by several threads at once, each
+ * with a position of its own.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_PGN_HPP__
+#define __BYTENOL_CHESS_PGN_HPP__
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include "position.hpp"
+#include "movegen.hpp"
+
+
+/**
+ * The legal move written as SAN in the position, e.g "Nbd7", "exd6",
+ * "O-O" or "e8=Q". Check and annotation suffixes are ignored. Returns the
+ * null move when no legal move or more than one fits.
+ */
+Move parseSan(const Position& position, std::string_view san);
+
+/**
+ * The move in SAN, with the shortest disambiguation and a "+" or "#"
+ * suffix. The move is played and taken back on the position to find the
+ * check, which is why the position is not const.
+ */
+std::string moveToSan(Position& position, Move m);
+
+
+struct PgnGame
+{
+    // the tag pair lines as they are in the file
+    std::string_view tags;
+    // where the game starts in the text
+    size_t offset = 0;
+
+    /**
+     * The value of a tag pair, e.g GetTag("White"), empty when it is missing.
+     * Escaped quotes are left as they are.
+     */
+    std::string_view GetTag(std::string_view name) const;
+};
+
+struct PgnStats
+{
+    uint64_t games = 0;
+    uint64_t positions = 0;
+    // games cut short by a move or FEN that could not be read
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * Called with the position before the first move (and a null move), then
+ * after every move with the move that led to it. With several threads the
+ * callback runs concurrently, the positions of one game always come in
+ * order from the same thread.
+ */
+using PgnCallback = std::function<void(const PgnGame& game, const Position& position, Move move)>;
+
+/**
+ * Reads every game of the PGN text. The games start from the initial
+ * position or the one in their FEN tag. A game with a move that cannot be
+ * resolved is counted as an error and left at that move.
+ */
+PgnStats readPgn(std::string_view text, const PgnCallback& callback, int threads = 1);
+
+/**
+ * readPgn() on a memory mapped file, false when it cannot be mapped.
+ */
+bool readPgnFile(const char* path, const PgnCallback& callback, int threads, PgnStats& stats);
+
+#endif
@@ -0,0 +1,644 @@
+/*****************************************************************//**
+ * \file   position.cpp
+ * \brief  Make/unmake for the incrementally updated board state
+ *********************************************************************/
+
+#include <algorithm>
+#include <charconv>
+
+#include "position.hpp"
+#include "notation.hpp"
+
+namespace
+{
+    // castling rights lost when a move starts from or lands on the square
+    constexpr uint8_t CASTLING_MASK[SQUARE_NB] = {
+        Position::BLACK_OOO, 0, 0, 0, Position::BLACK_OO | Position::BLACK_OOO, 0, 0, Position::BLACK_OO,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        Position::WHITE_OOO, 0, 0, 0, Position::WHITE_OO | Position::WHITE_OOO, 0, 0, Position::WHITE_OO,
+    };
+
+    struct CastlingPath
+    {
+        uint8_t right;
+        int kingFrom, kingTo;
+        Bitboard between;   // must be empty
+        Bitboard kingPath;  // must not be attacked
+    };
+
+    // indexed by [color][kingSide]
+    constexpr CastlingPath CASTLING_PATHS[COLOR_NB][2] = {
+        {
+            { Position::BLACK_OOO, 4, 2, SquareBB(1) | SquareBB(2) | SquareBB(3), SquareBB(2) | SquareBB(3) | SquareBB(4) },
+            { Position::BLACK_OO, 4, 6, SquareBB(5) | SquareBB(6), SquareBB(4) | SquareBB(5) | SquareBB(6) },
+        },
+        {
+            { Position::WHITE_OOO, 60, 58, SquareBB(57) | SquareBB(58) | SquareBB(59), SquareBB(58) | SquareBB(59) | SquareBB(60) },
+            { Position::WHITE_OO, 60, 62, SquareBB(61) | SquareBB(62), SquareBB(60) | SquareBB(61) | SquareBB(62) },
+        },
+    };
+
+    // the square just behind a pawn that moved two steps
+    inline int PawnBehind(int color, int sq)
+    {
+        return color == WHITE ? sq + 8 : sq - 8;
+    }
+
+    // FEN letters of the black pieces by CharacterName, the white ones are upper case
+    constexpr char PIECE_LETTERS[] = " prnbkq";
+
+    constexpr CharacterName letterToName(char c)
+    {
+        switch (c | 0x20)
+        {
+        case 'p': return CharacterName::PAWN;
+        case 'r': return CharacterName::ROOK;
+        case 'n': return CharacterName::KNIGHT;
+        case 'b': return CharacterName::BISHOP;
+        case 'k': return CharacterName::KING;
+        case 'q': return CharacterName::QUEEN;
+        default: return CharacterName::NONE;
+        }
+    }
+
+    // the next field of a FEN, fields are separated by one or more spaces
+    std::string_view nextField(std::string_view text, size_t& pos)
+    {
+        while (pos < text.size() && text[pos] == ' ')
+            pos++;
+
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != ' ')
+            pos++;
+
+        return text.substr(start, pos - start);
+    }
+
+    bool parseNumber(std::string_view field, int& value)
+    {
+        const char* end = field.data() + field.size();
+        auto [ptr, ec] = std::from_chars(field.data(), end, value);
+        return ec == std::errc() && ptr == end && value >= 0;
+    }
+}
+
+
+Position::Position()
+{
+    history.reserve(MAX_HISTORY);
+    Clear();
+}
+
+
+void Position::Clear()
+{
+    for (auto& boards : pieceBB)
+        for (auto& b : boards)
+            b = 0;
+
+    colorBB[BLACK] = colorBB[WHITE] = 0;
+    occupiedBB = 0;
+    material[BLACK] = material[WHITE] = 0;
+
+    for (auto& name : board)
+        name = CharacterName::NONE;
+
+    sideToMove = WHITE;
+    startPly = 0;
+    st = StateInfo{};
+    history.clear();
+}
+
+
+void Position::SetStartPosition()
+{
+    SetFen(START_FEN);
+}
+
+
+bool Position::SetFen(std::string_view fen)
+{
+    auto fail = [this]()
+    {
+        Clear();
+        return false;
+    };
+
+    Clear();
+
+    size_t pos = 0;
+    auto placement = nextField(fen, pos);
+    auto side = nextField(fen, pos);
+    auto castling = nextField(fen, pos);
+    auto ep = nextField(fen, pos);
+    auto halfmove = nextField(fen, pos);
+    auto fullmove = nextField(fen, pos);
+
+    // rows from 0 (the 8th rank) down, every one of them exactly 8 squares wide
+    int x = 0, y = 0;
+    for (char c : placement)
+    {
+        if (c == '/')
+        {
+            if (x != 8 || ++y > 7)
+                return fail();
+            x = 0;
+        }
+        else if (c >= '1' && c <= '8')
+        {
+            x += c - '0';
+            if (x > 8)
+                return fail();
+        }
+        else
+        {
+            auto name = letterToName(c);
+            if (name == CharacterName::NONE || x > 7)
+                return fail();
+            PutPiece(c >= 'a' ? BLACK : WHITE, name, MakeSquare(x++, y));
+        }
+    }
+
+    if (x != 8 || y != 7 || (GetPieces(CharacterName::PAWN) & (RowBB(0) | RowBB(7))))
+        return fail();
+
+    // the rest of the code expects one king per side and no more than 16 pieces
+    for (int color : { BLACK, WHITE })
+        if (PopCount(GetPieces(color, CharacterName::KING)) != 1 || PopCount(colorBB[color]) > 16)
+            return fail();
+
+    if (side == "w")
+        SetSideToMove(WHITE);
+    else if (side == "b")
+        SetSideToMove(BLACK);
+    else
+        return fail();
+
+    // the side that just moved cannot have left its king attacked
+    if (IsSquareAttacked(GetKingSquare(sideToMove ^ 1), sideToMove))
+        return fail();
+
+    int rights = 0;
+    for (char c : castling)
+    {
+        switch (c)
+        {
+        case 'K': rights |= WHITE_OO; break;
+        case 'Q': rights |= WHITE_OOO; break;
+        case 'k': rights |= BLACK_OO; break;
+        case 'q': rights |= BLACK_OOO; break;
+        case '-': break;
+        default: return fail();
+        }
+    }
+
+    for (int color : { BLACK, WHITE })
+        for (bool kingSide : { false, true })
+        {
+            const auto& path = CASTLING_PATHS[color][kingSide];
+            int rook = kingSide ? path.kingFrom + 3 : path.kingFrom - 4;
+            if (!TestBit(GetPieces(color, CharacterName::KING), path.kingFrom) || !TestBit(GetPieces(color, CharacterName::ROOK), rook))
+                rights &= ~path.right;
+        }
+    SetCastlingRights(rights);
+
+    if (!ep.empty() && ep != "-")
+    {
+        // behind the enemy pawn that just moved two steps
+        int sq = ep.size() == 2 ? parseSquare(ep.data()) : -1;
+        if (sq < 0 || SquareY(sq) != (sideToMove == WHITE ? 2 : 5))
+            return fail();
+        SetEnPassantSquare(sq);
+    }
+
+    int rule50 = 0, moveNumber = 1;
+    if ((!halfmove.empty() && !parseNumber(halfmove, rule50)) || (!fullmove.empty() && !parseNumber(fullmove, moveNumber)))
+        return fail();
+    if (rule50 > UINT16_MAX)
+        return fail();
+
+    st.rule50 = static_cast<uint16_t>(rule50);
+    // some writers start counting at 0
+    startPly = 2 * (std::max(moveNumber, 1) - 1) + (sideToMove == BLACK);
+    st.attacksReady = 0;
+    return true;
+}
+
+
+size_t Position::WriteFen(char* buffer) const
+{
+    char* out = buffer;
+
+    for (int y = 0; y < 8; y++)
+    {
+        int empty = 0;
+        for (int x = 0; x < 8; x++)
+        {
+            int sq = MakeSquare(x, y);
+            if (board[sq] == CharacterName::NONE)
+            {
+                empty++;
+                continue;
+            }
+
+            if (empty)
+                *out++ = static_cast<char>('0' + empty);
+            empty = 0;
+
+            char letter = PIECE_LETTERS[static_cast<int>(board[sq])];
+            *out++ = TestBit(colorBB[WHITE], sq) ? static_cast<char>(letter - 'a' + 'A') : letter;
+        }
+
+        if (empty)
+            *out++ = static_cast<char>('0' + empty);
+        if (y < 7)
+            *out++ = '/';
+    }
+
+    *out++ = ' ';
+    *out++ = sideToMove == WHITE ? 'w' : 'b';
+    *out++ = ' ';
+
+    if (!st.castling)
+        *out++ = '-';
+    if (st.castling & WHITE_OO) *out++ = 'K';
+    if (st.castling & WHITE_OOO) *out++ = 'Q';
+    if (st.castling & BLACK_OO) *out++ = 'k';
+    if (st.castling & BLACK_OOO) *out++ = 'q';
+    *out++ = ' ';
+
+    if (st.epSquare >= 0)
+    {
+        *out++ = static_cast<char>('a' + SquareX(st.epSquare));
+        *out++ = static_cast<char>('8' - SquareY(st.epSquare));
+    }
+    else
+        *out++ = '-';
+
+    char* end = buffer + FEN_CAPACITY - 1;
+    *out++ = ' ';
+    out = std::to_chars(out, end, st.rule50).ptr;
+    *out++ = ' ';
+    out = std::to_chars(out, end, GetFullmoveNumber()).ptr;
+    *out = '\0';
+
+    return static_cast<size_t>(out - buffer);
+}
+
+
+void Position::PutPiece(int color, CharacterName name, int sq)
+{
+    auto bb = SquareBB(sq);
+    pieceBB[color][static_cast<int>(name)] |= bb;
+    colorBB[color] |= bb;
+    occupiedBB |= bb;
+    board[sq] = name;
+    material[color] += PIECE_POINTS[static_cast<int>(name)];
+    st.key ^= ZOBRIST.psq[color][static_cast<int>(name)][sq];
+    st.attacksReady = 0;
+}
+
+
+void Position::RemovePiece(int sq)
+{
+    auto name = board[sq];
+    int color = GetColorAt(sq);
+    auto bb = SquareBB(sq);
+
+    pieceBB[color][static_cast<int>(name)] ^= bb;
+    colorBB[color] ^= bb;
+    occupiedBB ^= bb;
+    board[sq] = CharacterName::NONE;
+    material[color] -= PIECE_POINTS[static_cast<int>(name)];
+    st.key ^= ZOBRIST.psq[color][static_cast<int>(name)][sq];
+    st.attacksReady = 0;
+}
+
+
+void Position::MovePiece(int from, int to)
+{
+    auto name = board[from];
+    int color = GetColorAt(from);
+    auto bb = SquareBB(from) | SquareBB(to);
+
+    pieceBB[color][static_cast<int>(name)] ^= bb;
+    colorBB[color] ^= bb;
+    occupiedBB ^= bb;
+    board[to] = name;
+    board[from] = CharacterName::NONE;
+    st.key ^= ZOBRIST.psq[color][static_cast<int>(name)][from] ^ ZOBRIST.psq[color][static_cast<int>(name)][to];
+}
+
+
+void Position::MakeMove(Move m)
+{
+    history.push_back(st);
+
+    int us = sideToMove;
+    int from = m.From(), to = m.To();
+    auto name = board[from];
+
+    st.move = m;
+    st.attacksReady = 0;
+    st.captured = CharacterName::NONE;
+    st.rule50++;
+    st.key ^= ZOBRIST.side;
+
+    if (st.epSquare >= 0)
+    {
+        st.key ^= ZOBRIST.epFile[SquareX(st.epSquare)];
+        st.epSquare = -1;
+    }
+
+    if (m.Flags() == Move::EN_PASSANT)
+    {
+        st.captured = CharacterName::PAWN;
+        RemovePiece(PawnBehind(us, to));
+    }
+    else if (m.IsCapture())
+    {
+        st.captured = board[to];
+        RemovePiece(to);
+    }
+
+    MovePiece(from, to);
+
+    if (m.IsCastle())
+    {
+        // the rook jumps over the king to the square it passed
+        bool kingSide = to > from;
+        MovePiece(kingSide ? to + 1 : to - 2, kingSide ? to - 1 : to + 1);
+    }
+    else if (m.IsPromotion())
+    {
+        RemovePiece(to);
+        PutPiece(us, m.GetPromotion(), to);
+    }
+
+    if (name == CharacterName::PAWN)
+    {
+        st.rule50 = 0;
+        if (m.Flags() == Move::DOUBLE_PUSH)
+            SetEnPassantSquare(PawnBehind(us, to));
+    }
+    else if (st.captured != CharacterName::NONE)
+        st.rule50 = 0;
+
+    if (int lost = st.castling & (CASTLING_MASK[from] | CASTLING_MASK[to]))
+    {
+        st.key ^= ZOBRIST.castling[st.castling] ^ ZOBRIST.castling[st.castling ^ lost];
+        st.castling ^= lost;
+    }
+    sideToMove ^= 1;
+}
+
+
+void Position::UnmakeMove()
+{
+    sideToMove ^= 1;
+
+    int us = sideToMove;
+    Move m = st.move;
+    int from = m.From(), to = m.To();
+
+    if (m.IsPromotion())
+    {
+        RemovePiece(to);
+        PutPiece(us, CharacterName::PAWN, to);
+    }
+    else if (m.IsCastle())
+    {
+        bool kingSide = to > from;
+        MovePiece(kingSide ? to - 1 : to + 1, kingSide ? to + 1 : to - 2);
+    }
+
+    MovePiece(to, from);
+
+    if (m.Flags() == Move::EN_PASSANT)
+        PutPiece(us ^ 1, CharacterName::PAWN, PawnBehind(us, to));
+    else if (st.captured != CharacterName::NONE)
+        PutPiece(us ^ 1, st.captured, to);
+
+    st = history.back();
+    history.pop_back();
+}
+
+
+void Position::MakeNullMove()
+{
+    history.push_back(st);
+
+    // the board does not change, so the cached attack maps stay valid
+    st.move = Move{};
+    st.captured = CharacterName::NONE;
+    st.rule50 = 0;
+    st.key ^= ZOBRIST.side;
+
+    if (st.epSquare >= 0)
+    {
+        st.key ^= ZOBRIST.epFile[SquareX(st.epSquare)];
+        st.epSquare = -1;
+    }
+
+    sideToMove ^= 1;
+}
+
+
+void Position::UnmakeNullMove()
+{
+    sideToMove ^= 1;
+    st = history.back();
+    history.pop_back();
+}
+
+
+Move Position::InferMove(int from, int to) const
+{
+    auto name = board[from];
+    int dx = SquareX(to) - SquareX(from);
+    int dy = SquareY(to) - SquareY(from);
+
+    if (name == CharacterName::KING && (dx == 2 || dx == -2))
+        return Move(from, to, dx > 0 ? Move::KING_CASTLE : Move::QUEEN_CASTLE);
+
+    if (name == CharacterName::PAWN)
+    {
+        if (dy == 2 || dy == -2)
+            return Move(from, to, Move::DOUBLE_PUSH);
+        if (dx != 0 && to == st.epSquare)
+            return Move(from, to, Move::EN_PASSANT);
+    }
+
+    return Move(from, to, board[to] != CharacterName::NONE ? Move::CAPTURE : Move::QUIET);
+}
+
+
+Bitboard Position::AttackersTo(int sq, Bitboard occupied) const
+{
+    auto rooks = GetPieces(CharacterName::ROOK) | GetPieces(CharacterName::QUEEN);
+    auto bishops = GetPieces(CharacterName::BISHOP) | GetPieces(CharacterName::QUEEN);
+
+    return (Attacks::Pawn(BLACK, sq) & GetPieces(WHITE, CharacterName::PAWN))
+        | (Attacks::Pawn(WHITE, sq) & GetPieces(BLACK, CharacterName::PAWN))
+        | (Attacks::Knight(sq) & GetPieces(CharacterName::KNIGHT))
+        | (Attacks::King(sq) & GetPieces(CharacterName::KING))
+        | (Attacks::Rook(sq, occupied) & rooks)
+        | (Attacks::Bishop(sq, occupied) & bishops);
+}
+
+
+template<Color Them>
+bool Position::IsSquareAttacked(int sq) const
+{
+    if (st.attacksReady & (1 << Them))
+        return TestBit(st.attacks[Them], sq);
+
+    // cheapest tests first, sliders need the magic lookups
+    if (Attacks::PAWN[Them ^ 1][sq] & pieceBB[Them][static_cast<int>(CharacterName::PAWN)]) return true;
+    if (Attacks::Knight(sq) & pieceBB[Them][static_cast<int>(CharacterName::KNIGHT)]) return true;
+    if (Attacks::King(sq) & pieceBB[Them][static_cast<int>(CharacterName::KING)]) return true;
+
+    auto queens = pieceBB[Them][static_cast<int>(CharacterName::QUEEN)];
+    if (Attacks::Rook(sq, occupiedBB) & (pieceBB[Them][static_cast<int>(CharacterName::ROOK)] | queens)) return true;
+    return Attacks::Bishop(sq, occupiedBB) & (pieceBB[Them][static_cast<int>(CharacterName::BISHOP)] | queens);
+}
+
+
+template<Color Us>
+Bitboard Position::GetAttacks() const
+{
+    if (st.attacksReady & (1 << Us))
+        return st.attacks[Us];
+
+    // pawns all at once, the other pieces one by one
+    Bitboard attacks = PawnAttacksBB<Us>(pieceBB[Us][static_cast<int>(CharacterName::PAWN)]);
+    Bitboard b = pieceBB[Us][static_cast<int>(CharacterName::KING)];
+    while (b)
+        attacks |= Attacks::King(PopLsb(b));
+
+    b = pieceBB[Us][static_cast<int>(CharacterName::KNIGHT)];
+    while (b)
+        attacks |= Attacks::Knight(PopLsb(b));
+
+    b = pieceBB[Us][static_cast<int>(CharacterName::BISHOP)] | pieceBB[Us][static_cast<int>(CharacterName::QUEEN)];
+    while (b)
+        attacks |= Attacks::Bishop(PopLsb(b), occupiedBB);
+
+    b = pieceBB[Us][static_cast<int>(CharacterName::ROOK)] | pieceBB[Us][static_cast<int>(CharacterName::QUEEN)];
+    while (b)
+        attacks |= Attacks::Rook(PopLsb(b), occupiedBB);
+
+    st.attacks[Us] = attacks;
+    st.attacksReady |= 1 << Us;
+    return attacks;
+}
+
+
+template<Color Us>
+bool Position::CanCastle(bool kingSide) const
+{
+    const auto& path = CASTLING_PATHS[Us][kingSide];
+
+    if (!(st.castling & path.right) || (occupiedBB & path.between))
+        return false;
+
+    return !(GetAttacks<Color(Us ^ 1)>() & path.kingPath);
+}
+
+
+template<Color Us>
+Bitboard Position::GetPinned() const
+{
+    constexpr Color Them = Color(Us ^ 1);
+    int king = GetKingSquare(Us);
+    Bitboard queens = pieceBB[Them][static_cast<int>(CharacterName::QUEEN)];
+
+    // enemy sliders that would see the king on an empty board
+    Bitboard snipers = (Attacks::Rook(king, 0) & (pieceBB[Them][static_cast<int>(CharacterName::ROOK)] | queens))
+        | (Attacks::Bishop(king, 0) & (pieceBB[Them][static_cast<int>(CharacterName::BISHOP)] | queens));
+
+    Bitboard pinned = 0;
+    while (snipers)
+    {
+        Bitboard blockers = Attacks::Between(king, PopLsb(snipers)) & occupiedBB;
+        if (PopCount(blockers) == 1)
+            pinned |= blockers & colorBB[Us];
+    }
+
+    return pinned;
+}
+
+
+template bool Position::IsSquareAttacked<WHITE>(int sq) const;
+template bool Position::IsSquareAttacked<BLACK>(int sq) const;
+template Bitboard Position::GetAttacks<WHITE>() const;
+template Bitboard Position::GetAttacks<BLACK>() const;
+template bool Position::CanCastle<WHITE>(bool kingSide) const;
+template bool Position::CanCastle<BLACK>(bool kingSide) const;
+template Bitboard Position::GetPinned<WHITE>() const;
+template Bitboard Position::GetPinned<BLACK>() const;
+
+
+int Position::CastleDestination(int color, bool kingSide)
+{
+    return CASTLING_PATHS[color][kingSide].kingTo;
+}
+
+
+void Position::SetEnPassantSquare(int sq)
+{
+    if (st.epSquare >= 0)
+        st.key ^= ZOBRIST.epFile[SquareX(st.epSquare)];
+
+    st.epSquare = -1;
+
+    // only remembered when a pawn can actually take, so transpositions hash alike.
+    // a square on row 5 is behind a white pawn, so black is the one capturing,
+    // and the pawn must stand in front of it with the squares it crossed empty
+    if (sq >= 0)
+    {
+        int capturer = SquareY(sq) == 5 ? BLACK : WHITE;
+        int pawn = PawnBehind(capturer, sq), origin = PawnBehind(capturer ^ 1, sq);
+        bool pushed = TestBit(GetPieces(capturer ^ 1, CharacterName::PAWN), pawn)
+            && board[sq] == CharacterName::NONE && board[origin] == CharacterName::NONE;
+        if (pushed && (Attacks::Pawn(capturer ^ 1, sq) & GetPieces(capturer, CharacterName::PAWN)))
+        {
+            st.epSquare = static_cast<int8_t>(sq);
+            st.key ^= ZOBRIST.epFile[SquareX(sq)];
+        }
+    }
+}
+
+
+uint64_t Position::ComputeKey() const
+{
+    uint64_t key = ZOBRIST.castling[st.castling];
+
+    for (int sq = 0; sq < SQUARE_NB; sq++)
+        if (board[sq] != CharacterName::NONE)
+            key ^= ZOBRIST.psq[GetColorAt(sq)][static_cast<int>(board[sq])][sq];
+
+    if (st.epSquare >= 0)
+        key ^= ZOBRIST.epFile[SquareX(st.epSquare)];
+    if (sideToMove == BLACK)
+        key ^= ZOBRIST.side;
+
+    return key;
+}
+
+
+bool Position::IsRepetition() const
+{
+    int end = std::min<int>(st.rule50, static_cast<int>(history.size()));
+
+    for (int i = 4; i <= end; i += 2)
+        if (history[history.size() - i].key == st.key)
+            return true;
+
+    return false;
+}
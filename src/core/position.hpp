@@ -0,0 +1,312 @@
+/*****************************************************************//**
+ * \file   position.hpp
+ * \brief  Incrementally updated board state
+ *
+ * A Position owns the bitboards, a square indexed mailbox and the material
+ * count for both sides. MakeMove() and UnmakeMove() update all of them in
+ * place, previous states are kept on a small undo stack so a search can
+ * walk the tree without copying the board.
+ *
+ * The Zobrist key is updated with every change to the board and kept in
+ * the state as well, so taking a move back restores it without any work.
+ *
+ * Attack maps for each side are computed on first use and cached in the
+ * state, so they are restored for free when a move is taken back.
+ *
+ * The layout follows initPlayers(): white starts on rows 6-7 and moves
+ * towards row 0.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_POSITION_HPP__
+#define __BYTENOL_CHESS_POSITION_HPP__
+
+#include <vector>
+#include <string>
+#include <string_view>
+
+#include "bitboard.hpp"
+#include "attacks.hpp"
+#include "types.hpp"
+#include "zobrist.hpp"
+
+
+class Position
+{
+public:
+    enum CastlingRight : uint8_t
+    {
+        WHITE_OO = 1,
+        WHITE_OOO = 2,
+        BLACK_OO = 4,
+        BLACK_OOO = 8,
+        ALL_CASTLING = 15
+    };
+
+    // everything MakeMove() cannot recompute when the move is taken back
+    struct StateInfo
+    {
+        Move move{};
+        CharacterName captured = CharacterName::NONE;
+        uint8_t castling = 0;
+        int8_t epSquare = -1;
+        uint16_t rule50 = 0;
+        uint64_t key = 0;
+
+        // lazily filled by GetAttacks(), one bit per color in attacksReady
+        mutable Bitboard attacks[COLOR_NB] = { 0, 0 };
+        mutable uint8_t attacksReady = 0;
+    };
+
+    static constexpr int MAX_HISTORY = 1024;
+
+    static constexpr const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // enough for any FEN WriteFen() produces, terminator included
+    static constexpr size_t FEN_CAPACITY = 128;
+
+    Position();
+
+    void Clear();
+
+    void SetStartPosition();
+
+    /**
+     * Sets up the board from a FEN string without allocating, returns false
+     * (and leaves an empty board) when the text is not a valid position.
+     * The fields after the side to move may be left out: no castling, no en
+     * passant square, a halfmove clock of 0 and move number 1.
+     * A position needs one king per side and the side that just moved not in
+     * check. Castling rights without the king and rook on their squares are
+     * dropped, so is an en passant square without the pawn that just moved
+     * two steps past it or no pawn to take it.
+     */
+    bool SetFen(std::string_view fen);
+
+    /**
+     * Writes the position as FEN into the buffer, which must hold at least
+     * FEN_CAPACITY characters, and returns the length without the terminator.
+     */
+    size_t WriteFen(char* buffer) const;
+
+    inline std::string GetFen() const
+    {
+        char buffer[FEN_CAPACITY];
+        return std::string(buffer, WriteFen(buffer));
+    }
+
+    void PutPiece(int color, CharacterName name, int sq);
+
+    void RemovePiece(int sq);
+
+    /**
+     * Plays a move, the move must at least be pseudo legal for the side to move.
+     */
+    void MakeMove(Move m);
+
+    /**
+     * Takes back the last move played with MakeMove().
+     */
+    void UnmakeMove();
+
+    /**
+     * Passes the turn, for null move pruning. The move is recorded as the
+     * null move and repetitions are not looked for across it.
+     */
+    void MakeNullMove();
+
+    void UnmakeNullMove();
+
+    /**
+     * Builds the move flags for a piece going from one square to another,
+     * e.g for moves picked on the board by the player.
+     */
+    Move InferMove(int from, int to) const;
+
+    /**
+     * Every piece of both colors attacking the square, looked up from the
+     * square itself (a knight on the square sees the knights that attack it, etc).
+     */
+    Bitboard AttackersTo(int sq, Bitboard occupied) const;
+
+    template<Color Them>
+    bool IsSquareAttacked(int sq) const;
+
+    inline bool IsSquareAttacked(int sq, int bySide) const
+    {
+        return bySide == WHITE ? IsSquareAttacked<WHITE>(sq) : IsSquareAttacked<BLACK>(sq);
+    }
+
+    /**
+     * All squares attacked by one side, cached until the next move.
+     */
+    template<Color Us>
+    Bitboard GetAttacks() const;
+
+    inline Bitboard GetAttacks(int color) const
+    {
+        return color == WHITE ? GetAttacks<WHITE>() : GetAttacks<BLACK>();
+    }
+
+    /**
+     * The enemy pieces giving check to the side to move.
+     */
+    inline Bitboard GetCheckers() const
+    {
+        return AttackersTo(GetKingSquare(sideToMove), occupiedBB) & colorBB[sideToMove ^ 1];
+    }
+
+    /**
+     * Pieces of the color that are the only thing between their king and an
+     * enemy slider, they may only move along that line.
+     */
+    template<Color Us>
+    Bitboard GetPinned() const;
+
+    inline bool InCheck() const
+    {
+        return IsSquareAttacked(GetKingSquare(sideToMove), sideToMove ^ 1);
+    }
+
+    /**
+     * Castling is possible when the right is still there, the squares between
+     * king and rook are empty and the king neither starts on, passes through
+     * nor lands on an attacked square.
+     */
+    template<Color Us>
+    bool CanCastle(bool kingSide) const;
+
+    inline bool CanCastle(int color, bool kingSide) const
+    {
+        return color == WHITE ? CanCastle<WHITE>(kingSide) : CanCastle<BLACK>(kingSide);
+    }
+
+    static int CastleDestination(int color, bool kingSide);
+
+    inline CharacterName GetNameAt(int sq) const
+    {
+        return board[sq];
+    }
+
+    inline int GetColorAt(int sq) const
+    {
+        if (TestBit(colorBB[WHITE], sq)) return WHITE;
+        if (TestBit(colorBB[BLACK], sq)) return BLACK;
+        return -1;
+    }
+
+    inline Bitboard GetPieces(int color, CharacterName name) const
+    {
+        return pieceBB[color][static_cast<int>(name)];
+    }
+
+    inline Bitboard GetPieces(CharacterName name) const
+    {
+        return pieceBB[BLACK][static_cast<int>(name)] | pieceBB[WHITE][static_cast<int>(name)];
+    }
+
+    inline Bitboard GetColorPieces(int color) const
+    {
+        return colorBB[color];
+    }
+
+    inline Bitboard GetOccupied() const
+    {
+        return occupiedBB;
+    }
+
+    inline int GetKingSquare(int color) const
+    {
+        return Lsb(pieceBB[color][static_cast<int>(CharacterName::KING)]);
+    }
+
+    inline int GetSideToMove() const
+    {
+        return sideToMove;
+    }
+
+    inline void SetSideToMove(int color)
+    {
+        if (color != sideToMove)
+            st.key ^= ZOBRIST.side;
+        sideToMove = color;
+    }
+
+    inline int GetCastlingRights() const
+    {
+        return st.castling;
+    }
+
+    inline void SetCastlingRights(int rights)
+    {
+        st.key ^= ZOBRIST.castling[st.castling] ^ ZOBRIST.castling[rights];
+        st.castling = static_cast<uint8_t>(rights);
+    }
+
+    inline int GetEnPassantSquare() const
+    {
+        return st.epSquare;
+    }
+
+    void SetEnPassantSquare(int sq);
+
+    inline uint64_t GetKey() const
+    {
+        return st.key;
+    }
+
+    /**
+     * Key computed from scratch, for checking the incremental one.
+     */
+    uint64_t ComputeKey() const;
+
+    /**
+     * True when the current position already occurred since the last
+     * capture or pawn move.
+     */
+    bool IsRepetition() const;
+
+    inline int GetMaterial(int color) const
+    {
+        return material[color];
+    }
+
+    inline const StateInfo& GetState() const
+    {
+        return st;
+    }
+
+    /**
+     * Plies since the start of the game, counting the ones before the FEN
+     * the position was set up from.
+     */
+    inline int GetGamePly() const
+    {
+        return startPly + static_cast<int>(history.size());
+    }
+
+    inline int GetFullmoveNumber() const
+    {
+        return GetGamePly() / 2 + 1;
+    }
+
+    inline int GetHalfmoveClock() const
+    {
+        return st.rule50;
+    }
+
+private:
+    Bitboard pieceBB[COLOR_NB][CHARACTER_NB];
+    Bitboard colorBB[COLOR_NB];
+    Bitboard occupiedBB;
+    CharacterName board[SQUARE_NB];
+    int material[COLOR_NB];
+    int sideToMove = WHITE;
+    int startPly = 0;
+
+    StateInfo st;
+    std::vector<StateInfo> history;
+
+    void MovePiece(int from, int to);
+};
+
+#endif
@@ -0,0 +1,564 @@
+/*****************************************************************//**
+ * \file   search.cpp
+ * \brief  Alpha-beta search for the computer player
+ *********************************************************************/
+
+#include "search.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#include "eval.hpp"
+#include "movegen.hpp"
+#include "notation.hpp"
+
+namespace
+{
+    // late move reductions grow with both the depth and the move number
+    struct ReductionTable
+    {
+        int8_t values[Search::MAX_PLY][MoveList::CAPACITY];
+
+        ReductionTable()
+        {
+            for (int d = 0; d < Search::MAX_PLY; d++)
+                for (size_t m = 0; m < MoveList::CAPACITY; m++)
+                    values[d][m] = d && m ? static_cast<int8_t>(0.75 + std::log(d) * std::log(m) / 2.25) : 0;
+        }
+    };
+
+    const ReductionTable REDUCTIONS;
+
+    // the table payload is the best move, the score and the static evaluation
+    inline uint64_t packEntry(Move m, int score, int eval)
+    {
+        return m.Raw() | (uint64_t(uint16_t(score)) << 16) | (uint64_t(uint16_t(eval)) << 32);
+    }
+
+    inline Move entryMove(uint64_t payload) { return Move::FromRaw(payload & 0xFFFF); }
+
+    inline int entryScore(uint64_t payload) { return int16_t((payload >> 16) & 0xFFFF); }
+
+    // mate scores are stored relative to the node, not the root
+    inline int scoreToTable(int score, int ply)
+    {
+        if (score >= Search::MATE_BOUND) return score + ply;
+        if (score <= -Search::MATE_BOUND) return score - ply;
+        return score;
+    }
+
+    inline int scoreFromTable(int score, int ply)
+    {
+        if (score >= Search::MATE_BOUND) return score - ply;
+        if (score <= -Search::MATE_BOUND) return score + ply;
+        return score;
+    }
+
+    inline bool hasPieces(const Position& position, int color)
+    {
+        return position.GetColorPieces(color)
+            & ~position.GetPieces(color, CharacterName::PAWN)
+            & ~position.GetPieces(color, CharacterName::KING);
+    }
+
+    // moves the best scored move left to the slot about to be searched
+    inline void pickNext(MoveList& moves, int* scores, size_t i)
+    {
+        size_t best = i;
+        for (size_t j = i + 1; j < moves.Size(); j++)
+            if (scores[j] > scores[best])
+                best = j;
+
+        std::swap(moves[i], moves[best]);
+        std::swap(scores[i], scores[best]);
+    }
+
+    // helper i searches a depth only when (depth + phase) / size is even,
+    // so the helpers spread over neighbouring depths
+    constexpr int SKIP_SIZE[] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+    constexpr int SKIP_PHASE[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    constexpr int TT_MOVE_SCORE = 1 << 30;
+    constexpr int CAPTURE_SCORE = 1 << 28;
+    constexpr int KILLER_SCORE = 1 << 27;
+}
+
+
+Search::Search(TranspositionTable& table, int threadIndex) :
+    table(table),
+    threadIndex(threadIndex)
+{
+    Clear();
+}
+
+
+void Search::Clear()
+{
+    std::memset(killers, 0, sizeof(killers));
+    std::memset(history, 0, sizeof(history));
+}
+
+
+Search::Info Search::Run(const Position& root, const Limits& searchLimits, const Reporter& report)
+{
+    position = root;
+    limits = searchLimits;
+    start = std::chrono::steady_clock::now();
+    nodes = 0;
+
+    // workers are armed by their pool, so a stop that comes before they start is not lost
+    if (!pooled)
+        stopped = false;
+
+    std::memset(killers, 0, sizeof(killers));
+    for (auto& side : history)
+        for (auto& from : side)
+            for (auto& h : from)
+                h /= 8;
+
+    Info info;
+    MoveList rootMoves;
+    generateLegal(position, rootMoves);
+    if (rootMoves.Empty())
+        return info;
+
+    // something to play even if the first iteration gets cut short
+    info.pv.push_back(rootMoves[0]);
+
+    int score = 0;
+    int maxDepth = std::clamp(limits.depth, 1, MAX_PLY - 1);
+
+    for (int depth = 1; depth <= maxDepth; depth++)
+    {
+        if (threadIndex > 0 && depth > 1)
+        {
+            int i = (threadIndex - 1) % static_cast<int>(std::size(SKIP_SIZE));
+            if ((depth + SKIP_PHASE[i]) / SKIP_SIZE[i] % 2)
+                continue;
+        }
+
+        // aspiration window around the last score, widened on failure
+        int delta = depth >= 5 ? 40 : INFINITE_SCORE;
+        int alpha = std::max(score - delta, -INFINITE_SCORE);
+        int beta = std::min(score + delta, INFINITE_SCORE);
+
+        while (true)
+        {
+            score = AlphaBeta(alpha, beta, depth, 0, false);
+            if (stopped)
+                break;
+
+            if (score <= alpha)
+                alpha = std::max(score - delta, -INFINITE_SCORE);
+            else if (score >= beta)
+                beta = std::min(score + delta, INFINITE_SCORE);
+            else
+                break;
+
+            delta += delta / 2;
+        }
+
+        if (stopped)
+            break;
+
+        info.depth = depth;
+        info.score = score;
+        info.pv.assign(pvTable[0], pvTable[0] + pvLength[0]);
+        info.nodes = GetNodes();
+        info.seconds = Elapsed();
+
+        if (report)
+            report(info);
+
+        // no point going deeper once a forced mate is found
+        if (std::abs(score) >= MATE_BOUND && MATE - std::abs(score) <= depth)
+            break;
+    }
+
+    info.nodes = GetNodes();
+    info.seconds = Elapsed();
+    return info;
+}
+
+
+int Search::AlphaBeta(int alpha, int beta, int depth, int ply, bool allowNull)
+{
+    if (depth <= 0)
+        return Quiescence(alpha, beta, ply);
+
+    pvLength[ply] = ply;
+    bool pvNode = beta - alpha > 1;
+
+    if ((CountNode() & 2047) == 0)
+        CheckLimits();
+    if (stopped)
+        return 0;
+
+    if (ply > 0)
+    {
+        if (position.GetState().rule50 >= 100 || position.IsRepetition())
+            return DRAW;
+
+        if (ply >= MAX_PLY - 1)
+            return evaluate(position);
+
+        // a shorter mate was already found elsewhere
+        alpha = std::max(alpha, -MATE + ply);
+        beta = std::min(beta, MATE - ply - 1);
+        if (alpha >= beta)
+            return alpha;
+    }
+
+    uint64_t key = position.GetKey();
+    Move ttMove{};
+    TranspositionTable::Data entry;
+
+    if (table.Enabled() && table.Probe(key, entry))
+    {
+        ttMove = entryMove(entry.payload);
+        int ttScore = scoreFromTable(entryScore(entry.payload), ply);
+
+        if (!pvNode && entry.depth >= depth
+            && (entry.bound == TranspositionTable::BOUND_EXACT
+                || (entry.bound == TranspositionTable::BOUND_LOWER && ttScore >= beta)
+                || (entry.bound == TranspositionTable::BOUND_UPPER && ttScore <= alpha)))
+            return ttScore;
+    }
+
+    int us = position.GetSideToMove();
+    bool inCheck = position.InCheck();
+    int staticEval = inCheck ? -INFINITE_SCORE : evaluate(position);
+
+    if (inCheck)
+        depth++;
+
+    // if passing still beats beta, a real move almost certainly does too
+    if (!pvNode && !inCheck && allowNull && depth >= 3 && staticEval >= beta && hasPieces(position, us))
+    {
+        int r = 2 + depth / 4;
+
+        position.MakeNullMove();
+        int score = -AlphaBeta(-beta, -beta + 1, depth - 1 - r, ply + 1, false);
+        position.UnmakeNullMove();
+
+        if (stopped)
+            return 0;
+        if (score >= beta)
+            return score >= MATE_BOUND ? beta : score;
+    }
+
+    MoveList moves;
+    generateLegal(position, moves);
+
+    if (moves.Empty())
+        return inCheck ? -MATE + ply : DRAW;
+
+    int scores[MoveList::CAPACITY];
+    ScoreMoves(moves, scores, ttMove, ply);
+
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove{};
+    int startAlpha = alpha;
+    int legal = 0;
+
+    for (size_t i = 0; i < moves.Size(); i++)
+    {
+        pickNext(moves, scores, i);
+        Move m = moves[i];
+
+        position.MakeMove(m);
+        legal++;
+        if (table.Enabled())
+            table.Prefetch(position.GetKey());
+
+        bool quiet = !m.IsCapture() && !m.IsPromotion();
+        int score;
+
+        if (legal == 1)
+            score = -AlphaBeta(-beta, -alpha, depth - 1, ply + 1, true);
+        else
+        {
+            int r = 0;
+            if (depth >= 3 && legal > 3 && quiet && !inCheck && !position.InCheck()
+                && m != killers[ply][0] && m != killers[ply][1])
+            {
+                r = REDUCTIONS.values[std::min(depth, MAX_PLY - 1)][std::min<size_t>(legal, MoveList::CAPACITY - 1)];
+                r = std::clamp(r - pvNode, 0, depth - 2);
+            }
+
+            // later moves are expected to fail low, so try to prove that with a null window first
+            score = -AlphaBeta(-alpha - 1, -alpha, depth - 1 - r, ply + 1, true);
+            if (score > alpha && r)
+                score = -AlphaBeta(-alpha - 1, -alpha, depth - 1, ply + 1, true);
+            if (score > alpha && score < beta)
+                score = -AlphaBeta(-beta, -alpha, depth - 1, ply + 1, true);
+        }
+
+        position.UnmakeMove();
+
+        if (stopped)
+            return 0;
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = m;
+
+            if (score > alpha)
+            {
+                alpha = score;
+
+                pvTable[ply][ply] = m;
+                for (int p = ply + 1; p < pvLength[ply + 1]; p++)
+                    pvTable[ply][p] = pvTable[ply + 1][p];
+                pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+
+                if (alpha >= beta)
+                {
+                    if (quiet)
+                    {
+                        if (killers[ply][0] != m)
+                        {
+                            killers[ply][1] = killers[ply][0];
+                            killers[ply][0] = m;
+                        }
+                        history[us][m.From()][m.To()] += depth * depth;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (table.Enabled())
+    {
+        auto bound = bestScore >= beta ? TranspositionTable::BOUND_LOWER
+            : bestScore > startAlpha ? TranspositionTable::BOUND_EXACT
+            : TranspositionTable::BOUND_UPPER;
+        table.Store(key, depth, bound, packEntry(bestMove, scoreToTable(bestScore, ply), staticEval));
+    }
+
+    return bestScore;
+}
+
+
+int Search::Quiescence(int alpha, int beta, int ply)
+{
+    pvLength[ply] = ply;
+
+    if ((CountNode() & 2047) == 0)
+        CheckLimits();
+    if (stopped)
+        return 0;
+
+    if (ply >= MAX_PLY - 1)
+        return evaluate(position);
+
+    bool inCheck = position.InCheck();
+    int bestScore = -INFINITE_SCORE;
+
+    // standing pat: the side to move does not have to capture anything
+    if (!inCheck)
+    {
+        bestScore = evaluate(position);
+        if (bestScore >= beta)
+            return bestScore;
+        alpha = std::max(alpha, bestScore);
+    }
+
+    // every evasion is looked at when in check, so mates are not missed
+    MoveList moves;
+    if (inCheck)
+        generateLegal(position, moves);
+    else
+        generateLegalCaptures(position, moves);
+
+    if (inCheck && moves.Empty())
+        return -MATE + ply;
+
+    int scores[MoveList::CAPACITY];
+    ScoreMoves(moves, scores, Move{}, ply);
+
+    for (size_t i = 0; i < moves.Size(); i++)
+    {
+        pickNext(moves, scores, i);
+        Move m = moves[i];
+
+        position.MakeMove(m);
+        int score = -Quiescence(-beta, -alpha, ply + 1);
+        position.UnmakeMove();
+
+        if (stopped)
+            return 0;
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            if (score > alpha)
+            {
+                alpha = score;
+                if (alpha >= beta)
+                    break;
+            }
+        }
+    }
+
+    return bestScore;
+}
+
+
+void Search::ScoreMoves(const MoveList& moves, int* scores, Move ttMove, int ply) const
+{
+    int us = position.GetSideToMove();
+
+    for (size_t i = 0; i < moves.Size(); i++)
+    {
+        Move m = moves[i];
+
+        if (m == ttMove)
+            scores[i] = TT_MOVE_SCORE;
+        else if (m.IsCapture() || m.IsPromotion())
+        {
+            // most valuable victim, then least valuable attacker
+            auto victim = m.Flags() == Move::EN_PASSANT ? CharacterName::PAWN : position.GetNameAt(m.To());
+            auto attacker = position.GetNameAt(m.From());
+            scores[i] = CAPTURE_SCORE + PIECE_POINTS[static_cast<int>(victim)] * 16 - PIECE_POINTS[static_cast<int>(attacker)];
+            if (m.IsPromotion())
+                scores[i] += PIECE_POINTS[static_cast<int>(m.GetPromotion())] * 16;
+        }
+        else if (m == killers[ply][0])
+            scores[i] = KILLER_SCORE + 1;
+        else if (m == killers[ply][1])
+            scores[i] = KILLER_SCORE;
+        else
+            scores[i] = std::min(history[us][m.From()][m.To()], KILLER_SCORE - 1);
+    }
+}
+
+
+void Search::CheckLimits()
+{
+    if (limits.nodes && GetNodes() >= limits.nodes)
+        stopped = true;
+
+    if (limits.moveTime && Elapsed() * 1000 >= limits.moveTime)
+        stopped = true;
+}
+
+
+double Search::Elapsed() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+SearchPool::SearchPool(TranspositionTable& table, int threads) :
+    table(table)
+{
+    SetThreads(threads);
+}
+
+
+void SearchPool::SetThreads(int threads)
+{
+    workers.clear();
+    for (int i = 0; i < std::max(1, threads); i++)
+    {
+        workers.push_back(std::make_unique<Search>(table, i));
+        workers.back()->pooled = true;
+    }
+}
+
+
+Search::Info SearchPool::Run(const Position& root, const Search::Limits& limits, const Search::Reporter& report)
+{
+    table.NewSearch();
+
+    std::vector<Search::Info> results(workers.size());
+    std::vector<std::thread> helpers;
+
+    if (!armed)
+        Arm();
+    armed = false;
+
+    for (size_t i = 1; i < workers.size(); i++)
+        helpers.emplace_back([&, i]() {
+            results[i] = workers[i]->Run(root, limits);
+            });
+
+    results[0] = workers[0]->Run(root, limits, [&](const Search::Info& info) {
+        if (!report)
+            return;
+        Search::Info total = info;
+        total.nodes = GetNodes();
+        report(total);
+        });
+
+    // the main worker decides when the search is over
+    for (size_t i = 1; i < workers.size(); i++)
+        workers[i]->Stop();
+    for (auto& t : helpers)
+        t.join();
+
+    Search::Info best = results[0];
+    for (size_t i = 1; i < results.size(); i++)
+        if (results[i].depth > best.depth && !results[i].pv.empty())
+            best = results[i];
+
+    best.nodes = GetNodes();
+    best.seconds = results[0].seconds;
+    return best;
+}
+
+
+void SearchPool::Arm()
+{
+    for (auto& w : workers)
+        w->stopped = false;
+    armed = true;
+}
+
+
+void SearchPool::Stop()
+{
+    for (auto& w : workers)
+        w->Stop();
+}
+
+
+uint64_t SearchPool::GetNodes() const
+{
+    uint64_t total = 0;
+    for (auto& w : workers)
+        total += w->GetNodes();
+    return total;
+}
+
+
+std::string infoToString(const Search::Info& info)
+{
+    std::ostringstream out;
+    out << "depth " << info.depth << " score ";
+
+    if (std::abs(info.score) >= Search::MATE_BOUND)
+    {
+        // plies to full moves, negative when getting mated
+        int plies = Search::MATE - std::abs(info.score);
+        out << "mate " << (info.score > 0 ? (plies + 1) / 2 : -(plies / 2));
+    }
+    else
+        out << "cp " << info.score;
+
+    out << " nodes " << info.nodes
+        << " nps " << static_cast<uint64_t>(info.seconds > 0 ? info.nodes / info.seconds : 0)
+        << " time " << static_cast<int64_t>(info.seconds * 1000)
+        << " pv";
+
+    for (auto m : info.pv)
+        out << ' ' << moveToString(m);
+
+    return out.str();
+}
@@ -0,0 +1,185 @@
+/*****************************************************************//**
+ * \file   search.hpp
+ * \brief  Alpha-beta search for the computer player
+ *
+ * Iterative deepening principal variation search with a quiescence search
+ * at the leaves. Moves are ordered by the transposition table move, captures
+ * (most valuable victim first), killer moves and the history heuristic,
+ * which lets null move pruning and late move reductions cut away most of
+ * the tree without missing much.
+ *
+ * The search works on its own copy of the position, so it can run on a
+ * thread of its own while the game keeps drawing. Stop() is safe to call
+ * from any thread.
+ *
+ * SearchPool runs several of them at once on the same root (lazy SMP):
+ * the workers only talk through the shared transposition table, and the
+ * helpers skip some depths so they do not all search the same tree in step.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_SEARCH_HPP__
+#define __BYTENOL_CHESS_SEARCH_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "position.hpp"
+#include "movelist.hpp"
+#include "tt.hpp"
+
+
+class Search
+{
+    friend class SearchPool;
+
+public:
+    static constexpr int MAX_PLY = 64;
+    static constexpr int DRAW = 0;
+    static constexpr int MATE = 32000;
+    static constexpr int INFINITE_SCORE = MATE + 1;
+    // scores beyond this are mates, counted in plies from the root
+    static constexpr int MATE_BOUND = MATE - MAX_PLY;
+
+    struct Limits
+    {
+        int depth = MAX_PLY - 1;
+        // milliseconds, 0 for no limit
+        int64_t moveTime = 0;
+        // 0 for no limit
+        uint64_t nodes = 0;
+    };
+
+    // result of the last finished iteration
+    struct Info
+    {
+        int depth = 0;
+        int score = 0;
+        uint64_t nodes = 0;
+        double seconds = 0;
+        std::vector<Move> pv;
+
+        inline Move BestMove() const
+        {
+            return pv.empty() ? Move{} : pv.front();
+        }
+    };
+
+    using Reporter = std::function<void(const Info&)>;
+
+    /**
+     * Worker 0 searches every depth, the others (helpers) skip some.
+     */
+    explicit Search(TranspositionTable& table, int threadIndex = 0);
+
+    /**
+     * Searches until the depth, time or node limit is reached or Stop() is
+     * called. The reporter, if any, is called after every finished iteration.
+     * The best move is null only when the side to move has no legal move.
+     * Call TranspositionTable::NewSearch() before, once per move.
+     */
+    Info Run(const Position& root, const Limits& limits, const Reporter& report = nullptr);
+
+    inline void Stop()
+    {
+        stopped = true;
+    }
+
+    /**
+     * Forgets the killer moves and history of the searches before, so the
+     * next game does not depend on the last one. Not while searching.
+     */
+    void Clear();
+
+    // readable from other threads while searching
+    inline uint64_t GetNodes() const
+    {
+        return nodes.load(std::memory_order_relaxed);
+    }
+
+private:
+    TranspositionTable& table;
+    Position position;
+    int threadIndex;
+    // set by a pool, which clears the stop itself
+    bool pooled = false;
+
+    Limits limits;
+    std::chrono::steady_clock::time_point start;
+    std::atomic<bool> stopped{ false };
+    // only this thread writes it, relaxed so counting stays a plain increment
+    std::atomic<uint64_t> nodes{ 0 };
+
+    Move pvTable[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+    Move killers[MAX_PLY][2];
+    int history[COLOR_NB][SQUARE_NB][SQUARE_NB];
+
+    int AlphaBeta(int alpha, int beta, int depth, int ply, bool allowNull);
+
+    int Quiescence(int alpha, int beta, int ply);
+
+    void ScoreMoves(const MoveList& moves, int* scores, Move ttMove, int ply) const;
+
+    void CheckLimits();
+
+    double Elapsed() const;
+
+    inline uint64_t CountNode()
+    {
+        uint64_t n = nodes.load(std::memory_order_relaxed) + 1;
+        nodes.store(n, std::memory_order_relaxed);
+        return n;
+    }
+};
+
+
+class SearchPool
+{
+public:
+    SearchPool(TranspositionTable& table, int threads);
+
+    /**
+     * Not while a search is running.
+     */
+    void SetThreads(int threads);
+
+    inline int GetThreads() const
+    {
+        return static_cast<int>(workers.size());
+    }
+
+    /**
+     * Runs every worker on the root until the main one is done and returns
+     * the result of the worker that finished the deepest iteration. Only the
+     * main worker reports, with the nodes of all workers.
+     */
+    Search::Info Run(const Position& root, const Search::Limits& limits, const Search::Reporter& report = nullptr);
+
+    /**
+     * Clears the stop left by the last search. Run() does it when it was not
+     * done before, call it before handing Run() to another thread so that a
+     * Stop() sent before that thread gets to Run() is not lost.
+     */
+    void Arm();
+
+    void Stop();
+
+private:
+    TranspositionTable& table;
+    std::vector<std::unique_ptr<Search>> workers;
+    bool armed = false;
+
+    uint64_t GetNodes() const;
+};
+
+/**
+ * One line per iteration in the style of UCI "info" output, e.g
+ * "depth 6 score cp 35 nodes 81234 nps 1204551 time 67 pv e2e4 e7e5".
+ */
+std::string infoToString(const Search::Info& info);
+
+#endif
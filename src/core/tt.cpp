@@ -0,0 +1,112 @@
+/*****************************************************************//**
+ * \file   tt.cpp
+ * \brief  Shared, lock free transposition table
+ *********************************************************************/
+
+#include "tt.hpp"
+
+
+void TranspositionTable::Resize(size_t mb)
+{
+    size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= (mb << 20))
+        count *= 2;
+
+    buckets.reset();
+    mask = 0;
+
+    if (mb > 0)
+    {
+        buckets = std::make_unique<Bucket[]>(count);
+        mask = count - 1;
+    }
+}
+
+
+void TranspositionTable::Clear()
+{
+    if (!buckets)
+        return;
+
+    for (uint64_t i = 0; i <= mask; i++)
+        for (auto& e : buckets[i].entries)
+        {
+            e.keyXorData.store(0, std::memory_order_relaxed);
+            e.data.store(0, std::memory_order_relaxed);
+        }
+
+    generation = 0;
+}
+
+
+bool TranspositionTable::Probe(uint64_t key, Data& out) const
+{
+    const Bucket& bucket = buckets[key & mask];
+
+    for (const auto& e : bucket.entries)
+    {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t check = e.keyXorData.load(std::memory_order_relaxed);
+
+        if ((check ^ data) == key && data)
+        {
+            out.payload = data >> 16;
+            out.depth = DepthOf(data);
+            out.bound = static_cast<Bound>(data & 3);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void TranspositionTable::Store(uint64_t key, int depth, Bound bound, uint64_t payload)
+{
+    Bucket& bucket = buckets[key & mask];
+    Entry* replace = &bucket.entries[0];
+    int worst = 1 << 30;
+
+    for (auto& e : bucket.entries)
+    {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t check = e.keyXorData.load(std::memory_order_relaxed);
+
+        if ((check ^ data) == key || !data)
+        {
+            replace = &e;
+            break;
+        }
+
+        // prefer evicting shallow entries left over from earlier searches
+        int age = (generation - GenerationOf(data)) & 63;
+        int value = DepthOf(data) - 8 * age;
+        if (value < worst)
+        {
+            worst = value;
+            replace = &e;
+        }
+    }
+
+    uint64_t data = Pack(depth, bound, generation, payload);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+
+int TranspositionTable::Hashfull() const
+{
+    if (!buckets)
+        return 0;
+
+    int used = 0, total = 0;
+    for (uint64_t i = 0; i < 250 && i <= mask; i++)
+        for (const auto& e : buckets[i].entries)
+        {
+            uint64_t data = e.data.load(std::memory_order_relaxed);
+            used += data && GenerationOf(data) == generation;
+            total++;
+        }
+
+    return used * 1000 / total;
+}
@@ -0,0 +1,126 @@
+/*****************************************************************//**
+ * \file   tt.hpp
+ * \brief  Shared, lock free transposition table
+ *
+ * The table is an array of cache line sized buckets of four entries.
+ * Each entry is two 64-bit words, the data word and the key xor'ed with
+ * the data. A reader only trusts an entry when the two words still xor
+ * back to its key, so threads can race on an entry without locks: a torn
+ * write just looks like a miss.
+ *
+ * The 64-bit data word holds the bound (2 bits), the search generation
+ * (6 bits), the depth (8 bits) and a 48-bit payload owned by the caller,
+ * e.g a move and score for the search or a node count for perft.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_TT_HPP__
+#define __BYTENOL_CHESS_TT_HPP__
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+
+class TranspositionTable
+{
+public:
+    enum Bound : uint8_t
+    {
+        BOUND_NONE,
+        BOUND_UPPER,
+        BOUND_LOWER,
+        BOUND_EXACT
+    };
+
+    struct Data
+    {
+        uint64_t payload;
+        int depth;
+        Bound bound;
+    };
+
+    static constexpr uint64_t PAYLOAD_MASK = (uint64_t(1) << 48) - 1;
+
+    TranspositionTable() = default;
+
+    explicit TranspositionTable(size_t mb)
+    {
+        Resize(mb);
+    }
+
+    /**
+     * Reallocates to the largest power of two bucket count within the budget
+     * and clears the table. Not thread safe.
+     */
+    void Resize(size_t mb);
+
+    void Clear();
+
+    /**
+     * Ages every entry, called once per search so stale entries get replaced first.
+     */
+    inline void NewSearch()
+    {
+        generation = (generation + 1) & 63;
+    }
+
+    bool Probe(uint64_t key, Data& data) const;
+
+    /**
+     * Stores into the key's bucket: an entry with the same key is updated
+     * in place, otherwise the shallowest and oldest entry is replaced.
+     */
+    void Store(uint64_t key, int depth, Bound bound, uint64_t payload);
+
+    /**
+     * Entries of the current generation per mille, sampled from the first buckets.
+     */
+    int Hashfull() const;
+
+    inline void Prefetch(uint64_t key) const
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(&buckets[key & mask]);
+#endif
+    }
+
+    inline size_t GetSize() const
+    {
+        return (mask + 1) * sizeof(Bucket);
+    }
+
+    inline bool Enabled() const
+    {
+        return buckets != nullptr;
+    }
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> keyXorData{ 0 };
+        std::atomic<uint64_t> data{ 0 };
+    };
+
+    struct alignas(64) Bucket
+    {
+        Entry entries[4];
+    };
+
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+    std::unique_ptr<Bucket[]> buckets;
+    uint64_t mask = 0;
+    uint8_t generation = 0;
+
+    static inline uint64_t Pack(int depth, Bound bound, uint8_t gen, uint64_t payload)
+    {
+        return bound | (uint64_t(gen) << 2) | (uint64_t(depth & 0xFF) << 8) | ((payload & PAYLOAD_MASK) << 16);
+    }
+
+    static inline int DepthOf(uint64_t data) { return (data >> 8) & 0xFF; }
+
+    static inline uint8_t GenerationOf(uint64_t data) { return (data >> 2) & 63; }
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*****************************************************************//**
+ * \file   types.hpp
+ * \brief  Basic chess types shared by the board, movegen and the game
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_TYPES_HPP__
+#define __BYTENOL_CHESS_TYPES_HPP__
+
+#include <cstdint>
+
+
+enum class CharacterName : uint8_t
+{
+    NONE,
+    PAWN,
+    ROOK,
+    KNIGHT,
+    BISHOP,
+    KING,
+    QUEEN
+};
+
+constexpr int CHARACTER_NB = 7;
+
+// colors follow Character::GetColor(), i.e 1 is white
+enum Color : int
+{
+    BLACK,
+    WHITE,
+    COLOR_NB
+};
+
+// material value of each CharacterName, the king is never traded so it is worth nothing here
+constexpr int PIECE_POINTS[CHARACTER_NB] = { 0, 1, 5, 3, 3, 0, 9 };
+
+
+/**
+ * A move packed into 16 bits: 6 bits origin, 6 bits destination and 4 flag bits.
+ * The flag layout makes captures and promotions a single bit test.
+ *
+ * Default construction leaves the move uninitialized so move lists can be
+ * declared without clearing them, use Move{} for the null move.
+ */
+class Move
+{
+    uint16_t data;
+
+public:
+    enum Flag : uint16_t
+    {
+        QUIET = 0,
+        DOUBLE_PUSH = 1,
+        KING_CASTLE = 2,
+        QUEEN_CASTLE = 3,
+        CAPTURE = 4,
+        EN_PASSANT = 5,
+        PROMO_KNIGHT = 8,
+        PROMO_BISHOP = 9,
+        PROMO_ROOK = 10,
+        PROMO_QUEEN = 11,
+        PROMO_KNIGHT_CAPTURE = 12,
+        PROMO_BISHOP_CAPTURE = 13,
+        PROMO_ROOK_CAPTURE = 14,
+        PROMO_QUEEN_CAPTURE = 15
+    };
+
+    constexpr Move() = default;
+
+    constexpr Move(int from, int to, int flags = QUIET)
+        : data(static_cast<uint16_t>(from | (to << 6) | (flags << 12)))
+    {
+    }
+
+    static constexpr Move FromRaw(uint16_t raw)
+    {
+        Move m{};
+        m.data = raw;
+        return m;
+    }
+
+    constexpr uint16_t Raw() const { return data; }
+
+    constexpr int From() const { return data & 0x3F; }
+
+    constexpr int To() const { return (data >> 6) & 0x3F; }
+
+    constexpr int Flags() const { return data >> 12; }
+
+    constexpr bool IsCapture() const { return Flags() & CAPTURE; }
+
+    constexpr bool IsPromotion() const { return Flags() & PROMO_KNIGHT; }
+
+    constexpr bool IsCastle() const { return Flags() == KING_CASTLE || Flags() == QUEEN_CASTLE; }
+
+    constexpr CharacterName GetPromotion() const
+    {
+        constexpr CharacterName promotions[4] = { CharacterName::KNIGHT, CharacterName::BISHOP, CharacterName::ROOK, CharacterName::QUEEN };
+        return promotions[Flags() & 3];
+    }
+
+    constexpr explicit operator bool() const { return data != 0; }
+
+    constexpr bool operator==(const Move& other) const { return data == other.data; }
+};
+
+#endif
@@ -0,0 +1,62 @@
+/*****************************************************************//**
+ * \file   zobrist.hpp
+ * \brief  Random keys for hashing positions
+ *
+ * A position's key is the xor of one key per (color, piece, square) on the
+ * board plus keys for castling rights, the en passant file and the side
+ * to move, so a move only needs a handful of xors to update it.
+ * The keys are generated at compile time from a fixed seed.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_ZOBRIST_HPP__
+#define __BYTENOL_CHESS_ZOBRIST_HPP__
+
+#include "bitboard.hpp"
+#include "types.hpp"
+
+
+struct ZobristKeys
+{
+    uint64_t psq[COLOR_NB][CHARACTER_NB][SQUARE_NB];
+    uint64_t castling[16];
+    uint64_t epFile[8];
+    uint64_t side;
+};
+
+
+constexpr ZobristKeys makeZobristKeys()
+{
+    ZobristKeys keys{};
+    uint64_t s = 0x2545F4914F6CDD1DULL;
+
+    // splitmix64
+    auto next = [&s]() {
+        uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+
+    for (auto& pieces : keys.psq)
+        for (int n = 1; n < CHARACTER_NB; n++)
+            for (auto& k : pieces[n])
+                k = next();
+
+    // every combination of rights is the xor of the single rights it contains
+    uint64_t rights[4] = { next(), next(), next(), next() };
+    for (int c = 0; c < 16; c++)
+        for (int i = 0; i < 4; i++)
+            if (c & (1 << i))
+                keys.castling[c] ^= rights[i];
+
+    for (auto& k : keys.epFile)
+        k = next();
+
+    keys.side = next();
+    return keys;
+}
+
+
+inline constexpr ZobristKeys ZOBRIST = makeZobristKeys();
+
+#endif
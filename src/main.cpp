@@ -15,23 +15,26 @@
 
 #include "main.hpp"
 
-constexpr unsigned int TILESIZE = 64;
+constexpr int TILESIZE = 64;
 constexpr unsigned int ROW = 8;
 constexpr unsigned int COL = 8;
+constexpr int BOARD_SIZE = TILESIZE * 8;
 
-Player *currentPlayer = nullptr, 
-    *nextPlayer = nullptr, 
-    *whitePlayer = nullptr, 
-    *blackPlayer = nullptr;
-    
-Player player1, player2;
+// animations advance in steps of this many seconds, whatever the frame rate
+constexpr double TIMESTEP = 1 / 60.0;
+// a longer stall is not caught up with
+constexpr double MAX_LAG = 0.25;
+constexpr float SLIDE_TIME = 0.15f;
 
-SDL_Rect checkPos;
+// the side panel, right of the board
+constexpr int PANEL_X = BOARD_SIZE + 16;
+constexpr int PANEL_WIDTH = 192;
+// plies in the move list of the panel
+constexpr size_t MOVE_LIST_PLIES = 16;
+constexpr int FONT_SIZE = 18;
 
-TTF_Font* font = nullptr;
+SDL_Rect checkPos;
 
-std::vector<std::vector<int>> CollisionBoard::colorBuffer;
-std::vector<std::vector<CharacterName>> CollisionBoard::nameBuffer;
 
 struct {
 
@@ -39,547 +42,462 @@ struct {
     SDL_Renderer* renderer = nullptr;
     bool windowShouldClose = false;
     SDL_Event evt;
+    // pixels per point, more than one on a high DPI display
+    float scale = 1.0f;
 
 } canvas;
 
 
+// the computer player, searching on its own thread
+struct {
 
-Character* currentChr = nullptr;
-std::vector<std::unique_ptr<Character>> characters;
-std::map<std::string, SDL_Texture*> textures;
-
-
-
-int main(int argc, char* argv[])
-{
-    if (!init()) return -1;
-    loadTextures();
-    initPlayers();
-    mainLoop();
+    bool plays[COLOR_NB] = { false, false };
+    bool gameOver = false;
+    Search::Limits limits;
+    TranspositionTable table{ 64 };
+    SearchPool search{ table, 1 };
+    std::future<Search::Info> result;
+    // set by the search thread, which also wakes the main loop up
+    std::atomic<bool> finished{ false };
+    // depth and score of the last move played, for the panel
+    std::string summary;
 
-    return 0;
-}
+} engine;
 
 
-Character::Character(Point2D p, CharacterName _name, bool _isWhite, bool _isTop, int _point)
-{
-    name = _name;
-    isWhite = _isWhite;
-    isTop = _isTop;
+// the board is kept in a texture of its own, only the squares whose
+// content changed are drawn into it again
+struct {
 
-    pos = p;
-    startPos.x = p.x;
-    startPos.y = p.y;
+    SDL_Texture* target = nullptr;
+    // what each square shows, see boardContent()
+    uint16_t shown[SQUARE_NB];
+    bool valid = false;
+    // the window must be put together again even if no square changed
+    bool exposed = true;
+    // the text shown in the panel
+    std::string panel;
 
-    point = _point;
-}
+} boardView;
 
-void Character::Draw(SDL_Renderer* renderer)
-{
-    SDL_Texture* texture = nullptr;
-    switch (name)
-    {
-    case CharacterName::PAWN:
-        texture = textures[isWhite ? "w_pawn" : "b_pawn"];
-        break;
-    case CharacterName::ROOK:
-        texture = textures[isWhite ? "w_rook" : "b_rook"];
-        break;
-    case CharacterName::KNIGHT:
-        texture = textures[isWhite ? "w_knight" : "b_knight"];
-        break;
-    case CharacterName::BISHOP:
-        texture = textures[isWhite ? "w_bishop" : "b_bishop"];
-        break;
-    case CharacterName::KING:
-        texture = textures[isWhite ? "w_king" : "b_king"];
-        break;
-    case CharacterName::QUEEN:
-        texture = textures[isWhite ? "w_queen" : "b_queen"];
-        break;
-    }
 
-    SDL_Rect dstRect{ pos.x * TILESIZE, pos.y * TILESIZE, TILESIZE, TILESIZE };
-    SDL_RenderCopy(renderer, texture, nullptr, &dstRect);
-}
+// the last move played, sliding from the square it left to where it landed
+struct {
 
+    bool active = false;
+    Sprite sprite = Sprite::W_PAWN;
+    int from = 0, to = 0;
+    float t = 0;
+    // the game ply on the board, one more starts a slide
+    int ply = -1;
 
-void Character::SetPos(int x, int y)
-{
-    pos.x = x;
-    pos.y = y;
-}
+} slide;
 
 
-inline int Character::GetPoint() const
-{
-    return point;
-}
 
+// slot of the selected piece of the current player
+int currentChr = Player::NO_PIECE;
+// points into argv when given with --fen
+const char* startFen = Position::START_FEN;
+// every game is appended to it, empty for none
+const char* logPath = "games.cgl";
+// frames to time with and without sprite batching before playing, 0 to just play
+int renderBenchFrames = 0;
+SpriteAtlas atlas;
+SpriteBatch sprites;
+GlyphAtlas glyphs;
+SpriteBatch labels;
+// off only to compare against one draw call per sprite
+bool batchSprites = true;
 
-decltype(Character::pos)& Character::GetPos()
-{
-    return pos;
-}
 
 
-Character::path_t Character::GetRookPath(Character& character)
+int main(int argc, char* argv[])
 {
-    path_t v;
-
-    // up and down
-    auto& pos = character.GetPos();
+    if (!parseArgs(argc, argv)) return 2;
+    if (!init()) return -1;
+    Attacks::Init();
+    loadTextures();
+    if (!initPlayers(startFen))
+    {
+        std::cerr << "invalid FEN: " << startFen << std::endl;
+        return 2;
+    }
 
-    Point2D p{ pos.x, pos.y };
+    if (renderBenchFrames > 0)
+        renderBench(renderBenchFrames);
+    else
+    {
+        // playing without a history beats not playing at all
+        if (*logPath && !Logger::Open(logPath))
+            std::cerr << "cannot write the game log " << logPath << std::endl;
+        Logger::NewGame();
 
-    auto loopThroughAxis = [&](const std::string& a = "y") {
-        for (int i = 0; i < 2; i++)
-        {
-            p.x = pos.x;
-            p.y = pos.y;
-
-            bool isHit = false;
-            int dir = i == 0 ? 1 : -1;
-            auto axis = a == "y" ? &p.y : &p.x;
-            auto mx_axis = (a == "y") ? CollisionBoard::ROW_SIZE : CollisionBoard::COL_SIZE;
-            *axis += dir;
-            
-            while (!isHit && *axis >= 0 && *axis < mx_axis)
-            {
-                auto color = CollisionBoard::GetColorAt(p.x, p.y);
-                if (color < 0)
-                    v.push_back(p);
-                else
-                {
-                    if (!(character.GetColor() == color)) v.push_back(p);
-                    isHit = true;
-                }
-                *axis += dir;
-            }
-        }
+        mainLoop();
 
-    };
+        // do not leave a search running while the globals go away
+        engine.search.Stop();
+        if (engine.result.valid())
+            engine.result.wait();
 
-    loopThroughAxis("y");
-    loopThroughAxis("x");
+        Logger::Close();
+    }
 
-    return v;
+    if (boardView.target)
+        SDL_DestroyTexture(boardView.target);
+    glyphs.Destroy();
+    atlas.Destroy();
+    return 0;
 }
 
 
-Character::path_t Character::GetBishopPath(Character& character)
+bool parseArgs(int argc, char* argv[])
 {
-    path_t v;
+    engine.limits.moveTime = 1000;
+    engine.search.SetThreads(std::max(1u, std::thread::hardware_concurrency()));
 
-    auto& pos = character.GetPos();
-    Point2D p{ pos.x, pos.y };
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
 
-    auto loopThroughAxis = [&](const std::string& a = "top") {
-        for (int i = 0; i < 2; i++)
+        if (!std::strcmp(argv[i], "--engine") && hasValue)
         {
-            p.x = pos.x;
-            p.y = pos.y;
-
-            int dir = i == 0 ? -1 : 1;
-            bool isHit = false;
-            p.x += dir;
-            p.y += (a == "top")? -1: 1;
-
-            while (!isHit && p.x >= 0 && p.x < CollisionBoard::COL_SIZE && p.y >= 0 && p.y < CollisionBoard::ROW_SIZE)
-            {
-                auto color = CollisionBoard::GetColorAt(p.x, p.y);
-                if (color < 0)
-                    v.push_back(p);
-                else
-                {
-                    if (!(character.GetColor() == color)) v.push_back(p);
-                    isHit = true;
-                }
-                p.x += dir;
-                p.y += (a == "top") ? -1 : 1;
-            }
-
+            std::string side = argv[++i];
+            engine.plays[WHITE] = side == "white" || side == "both";
+            engine.plays[BLACK] = side == "black" || side == "both";
         }
-    };
-
-    loopThroughAxis("top");
-    loopThroughAxis("down");
-
-    return v;
-}
-
-
-bool Character::MoveTo(Point2D dest)
-{
-    auto paths = GetPath();
-    
-    auto destPos = std::find_if(paths.begin(), paths.end(), [&dest](Point2D p) {
-        return (dest.x == p.x && dest.y == p.y);
-        });
-
-    if (destPos != paths.end())
-    {
-        auto color = CollisionBoard::GetColorAt(dest.x, dest.y);
-
-        if (color >= 0)
+        else if (!std::strcmp(argv[i], "--movetime") && hasValue)
+            engine.limits.moveTime = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--depth") && hasValue)
+            engine.limits.depth = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--threads") && hasValue)
+            engine.search.SetThreads(std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--fen") && hasValue)
+            startFen = argv[++i];
+        else if (!std::strcmp(argv[i], "--log") && hasValue)
+            logPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--render-bench") && hasValue)
+            renderBenchFrames = std::atoi(argv[++i]);
+        else
         {
-            auto name = CollisionBoard::GetNameAt(dest.x, dest.y);
-            if (name == CharacterName::KING)
-            {
-                std::cout << "Cannot erase a king" << std::endl;
-                return false;
-            }
-
-            auto piece = nextPlayer->GetPieceAt(dest);
-            auto& pieces = nextPlayer->GetPieces();
-            if (piece != pieces.end())
-            {
-                currentPlayer->AddScore((*piece)->GetPoint());
-                pieces.erase(piece);
-            }
+            std::cerr << "usage: chess [--engine white|black|both|none] [--movetime ms] [--depth n] [--threads n] [--fen \"<fen>\"] [--log file] [--render-bench frames]" << std::endl;
+            return false;
         }
-        
-        pos.x = dest.x;
-        pos.y = dest.y;
-
-        return true;
     }
 
-    return false;
+    return true;
 }
 
 
-
-std::vector<Point2D> Pawn::GetPath()
+CharacterName promotionChoice()
 {
-    std::vector<Point2D> v;
-    int yDir = (isTop ? 1 : -1);
-    int yStart = pos.y + yDir;
+    const Uint8* keys = SDL_GetKeyboardState(nullptr);
+    if (keys[SDL_SCANCODE_N]) return CharacterName::KNIGHT;
+    if (keys[SDL_SCANCODE_B]) return CharacterName::BISHOP;
+    if (keys[SDL_SCANCODE_R]) return CharacterName::ROOK;
+    return CharacterName::QUEEN;
+}
 
-    int itCount = IsFirstMove() ? 2 : 1;
 
-    Point2D p{ pos.x, 0 };
-    for (int i = 0; i < itCount; i++)
+void processEvent(SDL_Event& evt)
+{
+    if (evt.type == SDL_QUIT)
+        canvas.windowShouldClose = true;
+    if (evt.type == SDL_WINDOWEVENT)
+        boardView.exposed = true;
+    // the board texture lost what was drawn into it
+    if (evt.type == SDL_RENDER_TARGETS_RESET || evt.type == SDL_RENDER_DEVICE_RESET)
+        boardView.valid = false;
+    if (evt.type == SDL_KEYDOWN)
     {
-        p.y = yStart + (i * yDir);
-        if (p.x < 0 || p.x >= CollisionBoard::COL_SIZE || p.y < 0 || p.y >= CollisionBoard::ROW_SIZE)
-            continue;
-
-        auto color = CollisionBoard::GetColorAt(p.x, p.y);
-        if(color < 0)
-            v.push_back(p);
+        auto key = evt.key.keysym.sym;
+        if (key == SDLK_LEFT || key == SDLK_z)
+            stepHistory(false);
+        else if (key == SDLK_RIGHT || key == SDLK_y)
+            stepHistory(true);
     }
-
-    // left
-    p.y = yStart;
-    for (int i = 0; i < 2; i++)
+    if (evt.type == SDL_MOUSEBUTTONDOWN)
     {
-        p.x = pos.x + (i == 0 ? 1: -1);
-        if (p.x < 0 || p.x >= CollisionBoard::COL_SIZE || p.y < 0 || p.y >= CollisionBoard::ROW_SIZE)
-            continue;
-        auto color = CollisionBoard::GetColorAt(p.x, p.y);
-        if(color >= 0 && color != GetColor())
-            v.push_back(p);
-    }
-
-    return v;
-}
-
-
-
-std::vector<Point2D> Rook::GetPath()
-{
-    return Character::GetRookPath(*this);
-}
-
-
-std::vector<Point2D> Knight::GetPath()
-{
-    std::vector<Point2D> v;
-    Point2D p;
-
-    auto throughAxis = [&](const std::string& a = "y") {
-        for (int i = 0; i < 2; i++)
+        // the board belongs to the engine while it is thinking
+        if (evt.button.button == SDL_BUTTON_LEFT && !engine.plays[currentPlayer->GetColor()])
         {
+            int x = evt.button.x / static_cast<int>(CollisionBoard::TILE_SIZE);
+            int y = evt.button.y / static_cast<int>(CollisionBoard::TILE_SIZE);
 
-            auto axis1 = (a == "y") ? &p.y : &p.x;
-            auto axis2 = (a == "y") ? &p.x : &p.y;
-
-            auto& c_axis1 = (a == "y") ? pos.y : pos.x;
-            auto& c_axis2 = (a == "y") ? pos.x : pos.y;
+            // the window is wider than the board, clicks on the side panel must not wrap into the next row
+            if (x < 0 || y < 0 || x >= static_cast<int>(CollisionBoard::COL_SIZE) || y >= static_cast<int>(CollisionBoard::ROW_SIZE))
+                return;
 
-            *axis1 = c_axis1 + (i == 0 ? 2 : -2);
+            auto color = CollisionBoard::GetColorAt(x, y);
 
-            for (int j = 0; j < 2; j++)
+            if (currentChr == Player::NO_PIECE)
             {
-                *axis2 = c_axis2 + (j == 0 ? 1 : -1);
-                
-                if (p.x < 0 || p.x >= CollisionBoard::COL_SIZE || p.y < 0 || p.y >= CollisionBoard::ROW_SIZE)
-                    continue;
-
-                auto color = CollisionBoard::GetColorAt(p.x, p.y);
-                if (color < 0)
-                    v.push_back(p);
-                else
+                if (currentPlayer->GetColor() == color)
+                {
+                    currentChr = currentPlayer->GetPieceAt({ x, y });
+                    // because of the color buffer, selected must always be a valid piece 
+                    assert(currentChr != Player::NO_PIECE);
+                }
+            }
+            else
+            {
+                if (currentPlayer->MoveTo(currentChr, { x, y }, promotionChoice()))
                 {
-                    if (!(GetColor() == color)) v.push_back(p);
+                    Logger::NextTurn();
+                    currentChr = Player::NO_PIECE;
+                    currentPlayer = (currentPlayer->GetColor() == 1 ? blackPlayer : whitePlayer);
                 }
+                else
+                    currentChr = Player::NO_PIECE;
             }
         }
-    };
-
-    throughAxis("y");
-    throughAxis("x");
-
-    return v;
+    }
 }
 
 
-std::vector<Point2D> Bishop::GetPath()
+void stepHistory(bool forward)
 {
-   return GetBishopPath(*this);
-}
+    // with the engine on both sides there is nobody to hand the board to
+    if (engine.plays[WHITE] && engine.plays[BLACK])
+        return;
 
+    // a search of the position being left has nothing to say about the next one
+    if (engine.result.valid())
+    {
+        engine.search.Stop();
+        engine.result.wait();
+        engine.result = {};
+        engine.finished = false;
+    }
 
+    do
+    {
+        if (forward ? !MoveHistory::Redo() : !MoveHistory::Undo())
+            break;
 
-Character::path_t Queen::GetPath()
-{
-    path_t v;
+        if (forward)
+            Logger::NextTurn();
+        else
+            Logger::TakeBack();
+    } while (engine.plays[currentPlayer->GetColor()]);
 
-    auto path = GetRookPath(*this);
-    v.insert(v.begin(), path.begin(), path.end());
-    path = GetBishopPath(*this);
-    v.insert(v.begin(), path.begin(), path.end());
-    return v;
+    currentChr = Player::NO_PIECE;
+    engine.gameOver = false;
 }
 
 
-Character::path_t King::GetPath()
+void mainLoop()
 {
-    path_t v, vc;
+    const double frequency = static_cast<double>(SDL_GetPerformanceFrequency());
+    Uint64 last = SDL_GetPerformanceCounter();
+    double lag = 0;
+
+    while (!canvas.windowShouldClose)
+    {
+        updateEngine();
+        followMoves();
+        render(canvas.renderer);
 
-    // this is the normal king's path
-    for (int y = pos.y - 1; y < pos.y + 2; y++)
-        if (y >= 0 && y < CollisionBoard::ROW_SIZE)
+        // idle, sleep until the player or the search thread does something,
+        // while a piece slides wake up in time for its next step
+        int timeout = slide.active ? static_cast<int>(std::ceil((TIMESTEP - lag) * 1000)) : -1;
+        if (SDL_WaitEventTimeout(&canvas.evt, timeout))
         {
-            for (int x = pos.x - 1; x < pos.x + 2; x++)
-                if (x >= 0 && x < CollisionBoard::COL_SIZE)
-                    if(CollisionBoard::GetColorAt(x, y) != GetColor())
-                        vc.push_back({ x, y });
+            do
+                processEvent(canvas.evt);
+            while (SDL_PollEvent(&canvas.evt));
         }
 
-    // add castle path
-    if (!isCastled)
-    {
-        auto c_path = GetCastlePath();
-        vc.insert(vc.begin(), c_path.begin(), c_path.end());
+        // the clock only runs while something moves, time asleep is not animation time
+        Uint64 now = SDL_GetPerformanceCounter();
+        lag = slide.active ? std::min(lag + (now - last) / frequency, MAX_LAG) : 0;
+        last = now;
+        for (; lag >= TIMESTEP; lag -= TIMESTEP)
+            update(static_cast<float>(TIMESTEP));
     }
-
-    v = vc;
-    return v;
 }
 
 
-bool King::MoveTo(Point2D dest)
+void followMoves()
 {
-    
-    return false;
+    auto& position = CollisionBoard::GetPosition();
+    int ply = position.GetGamePly();
+    if (ply == slide.ply)
+        return;
+
+    // moves taken back, and the position the game starts from, show up at once
+    Move move = position.GetState().move;
+    slide.active = slide.ply >= 0 && ply == slide.ply + 1 && move;
+    slide.ply = ply;
+    if (!slide.active)
+        return;
+
+    slide.from = move.From();
+    slide.to = move.To();
+    slide.t = 0;
+    slide.sprite = pieceSprite(position.GetNameAt(slide.to), position.GetColorAt(slide.to));
 }
 
 
-bool King::IsInCheck()
+void boardContent(uint16_t content[SQUARE_NB])
 {
-    auto enemy = isWhite ? blackPlayer : whitePlayer;
-
-    for (const auto& piece : enemy->GetPieces())
+    auto& position = CollisionBoard::GetPosition();
+    for (int sq = 0; sq < SQUARE_NB; sq++)
     {
-        auto paths = piece->GetPath();
-        for (const auto& path : paths)
-        {
-            if (path.x == pos.x && path.y == pos.y)
-            {
-                return true;
-            }
-        }
+        auto name = position.GetNameAt(sq);
+        content[sq] = name == CharacterName::NONE ? 0 : static_cast<uint16_t>(static_cast<int>(pieceSprite(name, position.GetColorAt(sq))) + 1);
     }
 
-    return false;
-}
-
-Character::path_t King::GetCastlePath()
-{
-    path_t path;
-
-    if (!IsFirstMove()) return path;
-
-    int ty = isTop ? 0 : CollisionBoard::ROW_SIZE - 1;
+    // the sliding piece is drawn over the board until it lands
+    if (slide.active)
+        content[slide.to] = 0;
 
-    for (int i = 0; i < 2; i++)
+    if (currentChr != Player::NO_PIECE)
     {
-        int startX = (i == 0 ? pos.x - 1 : CollisionBoard::COL_SIZE - 2);
-        int endX = i == 0 ? 0 : pos.x;
-        int rx = i == 0 ? 0 : CollisionBoard::COL_SIZE - 1;
-        auto r = CollisionBoard::GetNameAt(rx, ty);
+        auto pos = currentPlayer->GetPieces().GetPos(currentChr);
+        content[MakeSquare(pos.x, pos.y)] |= SQUARE_SELECTED;
 
-        if (r == CharacterName::ROOK)
-        {
-            auto piece = currentPlayer->GetPieceAt({ rx, ty });
-            if (piece != currentPlayer->GetPieces().end() && (*piece)->IsFirstMove())
-            {
-                bool hasItem = false;
-                for (int i = startX; i > endX; i--)
-                {
-                    if (CollisionBoard::GetColorAt(i, ty) >= 0)
-                    {
-                        hasItem = true;
-                        break;
-                    }
-
-                    //TODO: use "for i" so the break keyword can be used early
-                    for (auto& piece : nextPlayer->GetPieces())
-                    {
-                        auto&& p = piece->GetPath();
-                        auto ind = std::find_if(p.begin(), p.end(), [&i, &ty](auto& tp){
-                            return tp.x == i && tp.y == ty;
-                        });
-                        if (ind != p.end())
-                            hasItem = true;
-                    }
-                }
-
-                if (!hasItem)
-                    path.push_back({ pos.x + (i == 0 ? -2: 2), ty});
-            }
-        }
+        for (auto move : currentPlayer->GetPath(currentChr))
+            content[move.To()] |= SQUARE_VISION;
     }
-
-    return path;
 }
 
 
-void processEvent(SDL_Event& evt)
+void addSquare(SpriteBatch& batch, int sq, uint16_t content)
 {
-    while (SDL_PollEvent(&evt))
-    {
-        if (evt.type == SDL_QUIT)
-            canvas.windowShouldClose = true;
-        if (evt.type == SDL_MOUSEBUTTONDOWN)
-        {
-            if (evt.button.button == SDL_BUTTON_LEFT)
-            {
-                int x = evt.button.x / CollisionBoard::TILE_SIZE;
-                int y = evt.button.y / CollisionBoard::TILE_SIZE;
+    int x = SquareX(sq), y = SquareY(sq);
+    SDL_Rect rect{ x * TILESIZE, y * TILESIZE, TILESIZE, TILESIZE };
 
-                auto name = CollisionBoard::GetNameAt(x, y);
-                auto color = CollisionBoard::GetColorAt(x, y);
-
-                if (!currentChr)
-                {
-                    if (currentPlayer->GetColor() == color)
-                    {
-                        auto selected = currentPlayer->GetPieceAt({ x, y });
-                        // because of the color buffer, selected must always be a valid piece 
-                        assert(selected != currentPlayer->GetPieces().end());
-                        currentChr = &(**selected);
-                    }
-                }
-                else
-                {
-                    if (currentChr->MoveTo({ x, y }))
-                    {
-                        currentChr = nullptr;
-                        currentPlayer = (currentPlayer->GetColor() == 1 ? blackPlayer : whitePlayer);
-                    }
-                    else
-                        currentChr = nullptr;
-                }
-            }
-        }
-    }
+    batch.Add(atlas, (x + y) % 2 ? Sprite::SQUARE_LIGHT : Sprite::SQUARE_DARK, rect);
+    if (content & SQUARE_SELECTED)
+        batch.Add(atlas, Sprite::SELECTED, rect);
+    if (content & SQUARE_VISION)
+        batch.Add(atlas, Sprite::VISION, rect);
+    if (content & SQUARE_PIECE)
+        batch.Add(atlas, static_cast<Sprite>((content & SQUARE_PIECE) - 1), rect);
 }
 
 
-void mainLoop()
+std::string panelText()
 {
-    while (!canvas.windowShouldClose)
+    auto& position = CollisionBoard::GetPosition();
+    std::string text = "White  " + std::to_string(whitePlayer->GetScore())
+        + "\nBlack  " + std::to_string(blackPlayer->GetScore()) + "\n\n";
+
+    switch (gameResult(position))
     {
-        update(1 / 60.0f);
-        processEvent(canvas.evt);
-        render(canvas.renderer);
+    case GameResult::WHITE_WINS: text += "White wins"; break;
+    case GameResult::BLACK_WINS: text += "Black wins"; break;
+    case GameResult::DRAW: text += "Stalemate"; break;
+    default:
+        text += position.GetSideToMove() == WHITE ? "White to play" : "Black to play";
+        if (position.InCheck())
+            text += ", check";
     }
-}
+    text += "\n";
 
+    if (!engine.summary.empty())
+        text += engine.summary + "\n";
+    text += "\n";
 
+    // the last moves, a white move and its reply on a line
+    size_t played = MoveHistory::GetPly();
+    int firstPly = position.GetGamePly() - static_cast<int>(played);
+    size_t ply = played > MOVE_LIST_PLIES ? played - MOVE_LIST_PLIES : 0;
 
-void initPlayers()
-{
-    bool player1IsWhite = true;
-    currentPlayer = player1IsWhite ? &player1 : &player2;
-    whitePlayer = player1IsWhite ? &player1 : &player2;
-    blackPlayer = player1IsWhite ? &player2 : &player1;
-    player1.Reset(player1IsWhite, false);
-    player2.Reset(!player1IsWhite, true);
+    for (size_t start = ply; ply < played; ply++)
+    {
+        int gamePly = firstPly + static_cast<int>(ply);
+        if (gamePly % 2 == 0)
+            text += std::to_string(gamePly / 2 + 1) + ". ";
+        else if (ply == start)
+            text += std::to_string(gamePly / 2 + 1) + "... ";
+
+        text += moveToString(MoveHistory::GetMove(ply));
+        text += gamePly % 2 ? "\n" : " ";
+    }
 
+    return text;
 }
 
 
-
-std::vector<std::unique_ptr<Character>>::iterator getPieceAt(Point2D pos)
+void render(SDL_Renderer* renderer)
 {
-    auto ind = std::find_if(characters.begin(), characters.end(), [&pos](auto& character) {
-        auto& p = character->GetPos();
-        return (p.x == pos.x && p.y == pos.y);
-        });
+    uint16_t content[SQUARE_NB];
+    boardContent(content);
 
-    return ind;
-}
+    Bitboard dirty = 0;
+    for (int sq = 0; sq < SQUARE_NB; sq++)
+        if (!boardView.valid || content[sq] != boardView.shown[sq])
+            dirty |= SquareBB(sq);
 
-void render(SDL_Renderer* renderer)
-{
-    SDL_RenderClear(renderer);
+    // a frame where nothing changed costs the comparisons and no drawing
+    std::string panel = panelText();
+    if (!dirty && !slide.active && !boardView.exposed && panel == boardView.panel)
+        return;
+    boardView.panel = std::move(panel);
+
+    // without render targets the board is drawn whole, every frame
+    bool direct = !boardView.target;
+    if (dirty && !direct)
+    {
+        SDL_SetRenderTarget(renderer, boardView.target);
+        // a target starts unscaled, the board is drawn into it in points too
+        SDL_RenderSetScale(renderer, canvas.scale, canvas.scale);
+
+        // cleared first, the tiles may not cover every pixel they land on
+        SDL_Rect cleared[SQUARE_NB];
+        int count = 0;
+        sprites.Clear();
+        for (Bitboard b = dirty; b;)
+        {
+            int sq = PopLsb(b);
+            cleared[count++] = { SquareX(sq) * TILESIZE, SquareY(sq) * TILESIZE, TILESIZE, TILESIZE };
+            addSquare(sprites, sq, content[sq]);
+        }
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderFillRects(renderer, cleared, count);
+        sprites.Draw(renderer, atlas, batchSprites);
+
+        SDL_SetRenderTarget(renderer, nullptr);
+    }
+
+    std::copy(content, content + SQUARE_NB, boardView.shown);
+    boardView.valid = true;
+    boardView.exposed = false;
+
+    // the window is put together again on every frame that is shown
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
 
     int W, H;
     SDL_GetWindowSize(canvas.window, &W, &H);
     SDL_Rect rect{ 0, 0, W, H };
-    SDL_RenderCopy(renderer, textures["bg_dark_brown"], nullptr, &rect);
 
-    for (auto i = 0; i < ROW; i++)
-    {
-        for (auto j = 0; j < COL; j++)
-        {
-            auto s = (i * ROW + j);
-            SDL_Texture* texture = nullptr;
-
-            if (i % 2)
-                texture = j % 2 ? textures["bg_dark_brown"] : textures["bg_light_brown"];
-            else
-                texture = j % 2 ? textures["bg_light_brown"] : textures["bg_dark_brown"];
+    sprites.Clear();
+    sprites.Add(atlas, Sprite::SQUARE_DARK, rect);
+    if (direct)
+        for (int sq = 0; sq < SQUARE_NB; sq++)
+            addSquare(sprites, sq, content[sq]);
+    sprites.Draw(renderer, atlas, batchSprites);
 
-            SDL_Rect dstRect{ j * TILESIZE, i * TILESIZE, TILESIZE, TILESIZE };
-            SDL_RenderCopy(renderer, texture, nullptr, &dstRect);
-        }
+    if (!direct)
+    {
+        SDL_Rect board{ 0, 0, BOARD_SIZE, BOARD_SIZE };
+        SDL_RenderCopy(renderer, boardView.target, nullptr, &board);
     }
 
-    if (currentChr)
+    if (slide.active)
     {
-        auto pos = currentChr->GetPos();
-        SDL_Rect rect{ pos.x * TILESIZE, pos.y * TILESIZE, TILESIZE, TILESIZE };
-        SDL_RenderCopy(renderer, textures["selected"], nullptr, &rect);
+        float t = slide.t * slide.t * (3 - 2 * slide.t);
+        float x = SquareX(slide.from) + (SquareX(slide.to) - SquareX(slide.from)) * t;
+        float y = SquareY(slide.from) + (SquareY(slide.to) - SquareY(slide.from)) * t;
 
-        auto visions = currentChr->GetPath();
-        for (auto& vec : visions)
-        {
-            int sz = TILESIZE;
-            int spacing = (TILESIZE - sz) / 2;
-            SDL_Rect rect{ vec.x * TILESIZE + spacing, vec.y * TILESIZE + spacing, sz, sz };
-            SDL_RenderCopy(renderer, textures["vision"], nullptr, &rect);
-        }
+        sprites.Clear();
+        sprites.Add(atlas, slide.sprite, { static_cast<int>(x * TILESIZE), static_cast<int>(y * TILESIZE), TILESIZE, TILESIZE });
+        sprites.Draw(renderer, atlas, batchSprites);
     }
 
-    player1.Render(renderer);
-    player2.Render(renderer);
-
     rect.x = 0;
     rect.y = 0;
     rect.w = CollisionBoard::TILE_SIZE * CollisionBoard::COL_SIZE;
@@ -587,8 +505,9 @@ void render(SDL_Renderer* renderer)
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderDrawRect(renderer, &rect);
 
-    auto text = solidText(renderer, "Hello world", { 550, 20 }, { 255, 255, 255 });
-    SDL_DestroyTexture(text);
+    labels.Clear();
+    glyphs.Add(labels, boardView.panel, PANEL_X, 16, { 255, 255, 255, 255 });
+    glyphs.Draw(renderer, labels, batchSprites);
 
     SDL_RenderPresent(renderer);
 }
@@ -596,207 +515,195 @@ void render(SDL_Renderer* renderer)
 
 void update(float dt)
 {
-    nextPlayer = currentPlayer == whitePlayer ? blackPlayer : whitePlayer;
-    CollisionBoard::Reset();
-    player1.Update();
-    player2.Update();
-}
-
+    if (!slide.active)
+        return;
 
-void loadTexture(const std::string& name, const std::string& path)
-{
-    auto p = std::string("../../../assets/sprites/PNGs/With Shadow/2x/") + path;
-    const char* _path = p.c_str();
-    SDL_Surface* surface = IMG_Load(_path);
-    if (!surface)
-        SDL_Log("Failed to load image: %s", IMG_GetError());
-
-    textures[name] = SDL_CreateTextureFromSurface(canvas.renderer, surface);
-    SDL_FreeSurface(surface);
+    slide.t += dt / SLIDE_TIME;
+    if (slide.t >= 1)
+        slide.active = false;
 }
 
 
-void loadTextures()
+void updateEngine()
 {
-    loadTexture("bg_dark_brown", "square brown dark_2x.png");
-    loadTexture("bg_light_brown", "square brown light_2x.png");
-    //loadTexture("bg_dark_gray", "square gray dark_2x.png");
-    //loadTexture("bg_light_gray", "square gray light_2x.png");
-    loadTexture("w_pawn", "w_pawn_2x.png");
-    loadTexture("b_pawn", "b_pawn_2x.png");
-    loadTexture("b_rook", "b_rook_2x.png");
-    loadTexture("w_rook", "w_rook_2x.png");
-    loadTexture("w_bishop", "w_bishop_2x.png");
-    loadTexture("b_bishop", "b_bishop_2x.png");
-    loadTexture("w_knight", "w_knight_2x.png");
-    loadTexture("b_knight", "b_knight_2x.png");
-    loadTexture("w_king", "w_king_2x.png");
-    loadTexture("b_king", "b_king_2x.png");
-    loadTexture("w_queen", "w_queen_2x.png");
-    loadTexture("b_queen", "b_queen_2x.png");
-    loadTexture("selected", "selected.png");
-    loadTexture("vision", "vision.png");
-}
+    nextPlayer = currentPlayer == whitePlayer ? blackPlayer : whitePlayer;
+    if (engine.gameOver || !engine.plays[currentPlayer->GetColor()])
+        return;
 
+    if (!engine.result.valid())
+    {
+        Position root = CollisionBoard::GetPosition();
+        // here, so that a Stop() before the thread starts searching still counts
+        engine.search.Arm();
+        engine.result = std::async(std::launch::async, [root]() {
+            auto info = engine.search.Run(root, engine.limits, [](const Search::Info& info) {
+                std::cout << infoToString(info) << std::endl;
+                });
+
+            // the main loop may be asleep waiting for events
+            engine.finished = true;
+            SDL_Event wake{};
+            wake.type = SDL_USEREVENT;
+            SDL_PushEvent(&wake);
+            return info;
+            });
+        return;
+    }
 
+    if (!engine.finished)
+        return;
 
-SDL_Texture* solidText(SDL_Renderer* renderer, const std::string& text, Point2D pos, SDL_Color color)
-{
-    const char* _text = text.c_str();
-    SDL_Surface* surface = TTF_RenderText_Solid(font, _text, color);
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    // the thread is only returning the result, get() does not wait for long
+    engine.finished = false;
+    auto info = engine.result.get();
+    engine.summary = "depth " + std::to_string(info.depth)
+        + (std::abs(info.score) >= Search::MATE_BOUND ? " mate" : " cp " + std::to_string(info.score));
+    Move best = info.BestMove();
 
-    SDL_Rect dest = { pos.x, pos.y, surface->w, surface->h };
-    SDL_FreeSurface(surface);
+    if (!best)
+    {
+        engine.gameOver = true;
+        std::cout << currentPlayer->GetName() << (CollisionBoard::GetPosition().InCheck() ? " is checkmated" : " is stalemated") << std::endl;
+        return;
+    }
 
-    return texture;
+    std::cout << currentPlayer->GetName() << " plays " << moveToString(best) << std::endl;
+    playMove(best);
+    Logger::NextTurn();
+    currentChr = Player::NO_PIECE;
+    currentPlayer = nextPlayer;
+    nextPlayer = currentPlayer == whitePlayer ? blackPlayer : whitePlayer;
 }
 
 
-bool init()
+bool openBundle(AssetBundle& bundle)
 {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0)
+    if (char* base = SDL_GetBasePath())
     {
-        std::cerr << "SDL2 Initialization failed: " << SDL_GetError() << std::endl;
-        return false;
+        std::string path = std::string(base) + Assets::BUNDLE;
+        SDL_free(base);
+        if (bundle.Open(path.c_str()))
+            return true;
     }
 
-    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG))
-        SDL_Log("SDL_image init failed: %s", IMG_GetError());
+    return bundle.Open(CHESS_BUNDLE_PATH);
+}
 
-    TTF_Init();
 
-    canvas.window = SDL_CreateWindow("Chess", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 512, 0);
-    if (!canvas.window)
-    {
-        std::cerr << "Unable to create SDL2 Window: " << SDL_GetError() << std::endl;
-        return false;
-    }
+void loadTextures()
+{
+    // a tile is this many pixels on screen, the sprites are made that size
+    int cellSize = static_cast<int>(std::lround(TILESIZE * canvas.scale));
+    int threads = std::max(1u, std::thread::hardware_concurrency());
 
-    canvas.renderer = SDL_CreateRenderer(canvas.window, -1, SDL_RENDERER_ACCELERATED);
-    if (!canvas.renderer)
+    auto start = std::chrono::steady_clock::now();
+
+    // only read while the textures are made
+    AssetBundle bundle;
+    openBundle(bundle);
+
+    const char* from = "the bundle";
+    bool loaded;
+    const BundleEntry* sheet = bundle.Find(Assets::SheetEntry(cellSize));
+    if (sheet && sheet->width == Atlas::SheetWidth(cellSize) && sheet->height == Atlas::SheetHeight(cellSize))
+        loaded = atlas.Load(canvas.renderer, sheet->data.data(), sheet->width * 4, cellSize);
+    else
     {
-        std::cerr << "Unable to create SDL2 Renderer: " << SDL_GetError() << std::endl;
-        return false;
+        // a display scale the bundle was not made for
+        from = chooseSpriteSet(cellSize).directory;
+        loaded = atlas.Load(canvas.renderer, std::string(CHESS_ASSETS_DIR) + Assets::SPRITES, cellSize, threads);
     }
+    if (!loaded)
+        std::cerr << "Unable to create the sprite atlas" << std::endl;
 
-    font = TTF_OpenFont("../../../assets/SpecialGothic-Regular.ttf", 24);
-    if (!font) {
+    const BundleEntry* font = bundle.Find(Assets::FONT_ENTRY);
+    if (font ? !glyphs.Load(canvas.renderer, font->data, FONT_SIZE)
+        : !glyphs.Load(canvas.renderer, std::string(CHESS_ASSETS_DIR) + Assets::FONT, FONT_SIZE))
         std::cerr << "Unable to load font" << std::endl;
-    }
 
-    return true;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "sprites at " << cellSize << " px from " << from << ", assets loaded in " << ms << " ms" << std::endl;
 }
 
 
-void CollisionBoard::Reset()
+void renderBench(int frames)
 {
-    // clear and update collision board
-    nameBuffer.clear();
-    colorBuffer.clear();
-
-    for (size_t i = 0; i < ROW_SIZE; i++)
+    for (bool batched : { false, true })
     {
-        nameBuffer.push_back({ });
-        colorBuffer.push_back({ });
-        for (size_t j = 0; j < COL_SIZE; j++)
+        batchSprites = batched;
+        // the first frames pay for driver warm up, in either mode
+        for (int i = 0; i < 10; i++)
+        {
+            boardView.valid = false;
+            render(canvas.renderer);
+        }
+
+        // every square is drawn again, as if the whole board had changed
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++)
         {
-            nameBuffer[i].push_back(CharacterName::NONE);
-            colorBuffer[i].push_back(-1);
+            boardView.valid = false;
+            render(canvas.renderer);
         }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << (batched ? "one batch       " : "call per sprite ") << ms / frames << " ms per frame" << std::endl;
     }
-}
 
+    // what the loop pays when it wakes up and nothing changed
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+        render(canvas.renderer);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "unchanged board " << ms / frames << " ms per frame" << std::endl;
 
-void CollisionBoard::SetPiece(Character& character)
-{
-    auto& pos = character.GetPos();
-    nameBuffer[pos.y][pos.x] = character.GetName();
-    colorBuffer[pos.y][pos.x] = character.isWhite ? 1 : 0;
+    batchSprites = true;
 }
 
 
-void Player::Reset(bool _isWhite, bool isTop)
+
+bool init()
 {
-    pieces.clear();
-    score = 0;
+    if (SDL_Init(SDL_INIT_VIDEO) != 0)
+    {
+        std::cerr << "SDL2 Initialization failed: " << SDL_GetError() << std::endl;
+        return false;
+    }
 
-    isWhite = _isWhite;
-    int topOffset = isTop ? 1 : -1;
-    int startY = isTop ? 0 : CollisionBoard::ROW_SIZE - 1;
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG))
+        SDL_Log("SDL_image init failed: %s", IMG_GetError());
 
-    Point2D pos{ 0, startY };
+    TTF_Init();
 
-    // make pawn
-    for (int x = 0; x < CollisionBoard::COL_SIZE; x++)
+    canvas.window = SDL_CreateWindow("Chess", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, BOARD_SIZE + PANEL_WIDTH, BOARD_SIZE, SDL_WINDOW_ALLOW_HIGHDPI);
+    if (!canvas.window)
     {
-        pos.x = x;
-        pos.y = startY + topOffset;
-        pieces.push_back(std::make_unique<Pawn>(pos, isWhite, isTop));
+        std::cerr << "Unable to create SDL2 Window: " << SDL_GetError() << std::endl;
+        return false;
     }
 
-    // setup rook, knight, bishop
-    pos.y = startY;
-
-    for (int i = 0; i < 2; i++)
+    canvas.renderer = SDL_CreateRenderer(canvas.window, -1, SDL_RENDERER_ACCELERATED);
+    if (!canvas.renderer)
     {
-        pos.x = i == 0 ? 0 : CollisionBoard::COL_SIZE - 1;
-        pieces.push_back(std::make_unique<Rook>(pos, isWhite, isTop));
-
-        pos.x = i == 0 ? 1 : CollisionBoard::COL_SIZE - 2;
-        pieces.push_back(std::make_unique<Knight>(pos, isWhite, isTop));
-
-        pos.x = i == 0 ? 2 : CollisionBoard::COL_SIZE - 3;
-        pieces.push_back(std::make_unique<Bishop>(pos, isWhite, isTop));
+        std::cerr << "Unable to create SDL2 Renderer: " << SDL_GetError() << std::endl;
+        return false;
     }
 
-    // make queens
-    pos.x = 3;
-    pieces.push_back(std::make_unique<Queen>(pos, isWhite, isTop));
-
-    // make kings
-    pos.x = 4;
-    pieces.push_back(std::make_unique<King>(pos, isWhite, isTop));
-
-}
+    // on a high DPI display the renderer has more pixels than the window has
+    // points, everything is still laid out in points
+    int pixels, points, h;
+    SDL_GetRendererOutputSize(canvas.renderer, &pixels, &h);
+    SDL_GetWindowSize(canvas.window, &points, &h);
+    if (pixels > 0 && points > 0)
+        canvas.scale = static_cast<float>(pixels) / points;
+    SDL_RenderSetScale(canvas.renderer, canvas.scale, canvas.scale);
+
+    int boardPixels = static_cast<int>(std::lround(BOARD_SIZE * canvas.scale));
+    boardView.target = SDL_CreateTexture(canvas.renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, boardPixels, boardPixels);
+    if (boardView.target)
+        SDL_SetTextureBlendMode(boardView.target, SDL_BLENDMODE_NONE);
+    else
+        SDL_Log("No render target, the board is drawn whole every frame: %s", SDL_GetError());
 
-
-void Player::Update()
-{
-    for (const auto& piece : pieces)
-        CollisionBoard::SetPiece(*piece);
-}
-
-void Player::Render(SDL_Renderer* renderer)
-{
-    for (const auto& piece : pieces)
-        piece->Draw(renderer);
-}
-
-
-std::vector<std::unique_ptr<Character>>::iterator Player::GetPieceAt(Point2D pos)
-{
-    auto ind = std::find_if(pieces.begin(), pieces.end(), [&pos](auto& piece) {
-        auto& p = piece->GetPos();
-        return (p.x == pos.x && p.y == pos.y);
-        });
-
-    return ind;
+    return true;
 }
-
-//std::unique_ptr<Character>& Player::GetKing() const
-//{
-//    for (auto& piece : pieces)
-//    {
-//        if (piece->GetName() == CharacterName::KING)
-//        {
-//            return **piece;
-//        }
-//    };
-//}
-
-
-inline void Logger::NextTurn()
-{
-    
-}
\ No newline at end of file
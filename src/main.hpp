@@ -23,274 +23,131 @@
 #include <memory>
 #include <map>
 #include <cassert>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+
+#include "game.hpp"
+#include "search.hpp"
+#include "notation.hpp"
+#include "bundle.hpp"
+#include "atlas.hpp"
+#include "text.hpp"
 
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 
+// the build sets both to where the sources and the bundle are
+#ifndef CHESS_ASSETS_DIR
+#define CHESS_ASSETS_DIR "assets/"
+#endif
+#ifndef CHESS_BUNDLE_PATH
+#define CHESS_BUNDLE_PATH "assets.bundle"
+#endif
 
-// forward classes declaration
-struct Point2D;
-class Character;
-class Player;
-class CollisionBoard;
 
-enum class CharacterName
+extern int currentChr;
+extern const char* startFen;
+extern const char* logPath;
+extern int renderBenchFrames;
+extern SpriteAtlas atlas;
+extern SpriteBatch sprites;
+extern GlyphAtlas glyphs;
+extern SpriteBatch labels;
+extern bool batchSprites;
+
+
+// what boardContent() says a square shows, besides the piece sprite plus one in the low bits
+enum SquareContent : uint16_t
 {
-    NONE,
-    PAWN,
-    ROOK,
-    KNIGHT,
-    BISHOP,
-    KING,
-    QUEEN
+    SQUARE_PIECE = 0xFF,
+    SQUARE_SELECTED = 0x100,
+    SQUARE_VISION = 0x200
 };
 
-extern Character* currentChr;
-extern std::map<std::string, SDL_Texture*> textures;
-extern Player player1, player2;
-extern Player *currentPlayer, *nextPlayer, *whitePlayer, *blackPlayer;
-extern TTF_Font* font;
+/**
+ * Draws the squares whose content changed into the board texture and shows
+ * the window, nothing at all when no square changed and nothing moves.
+ */
+void render(SDL_Renderer* renderer);
 
+/**
+ * What every square shows now, as SquareContent.
+ */
+void boardContent(uint16_t content[SQUARE_NB]);
 
-std::vector<std::unique_ptr<Character>>::iterator getPieceAt(Point2D pos);
+void addSquare(SpriteBatch& batch, int sq, uint16_t content);
 
-void render(SDL_Renderer* renderer);
+/**
+ * Scores, whose turn it is, the last search and the last moves, a line
+ * each. Only lines not shown before are laid out again.
+ */
+std::string panelText();
 
+/**
+ * Advances the animations by one fixed step of dt seconds.
+ */
 void update(float dt);
 
+/**
+ * Starts sliding the piece of a move played since the last call.
+ */
+void followMoves();
+
 void processEvent(SDL_Event& evt);
 
+/**
+ * Sleeps in SDL_WaitEventTimeout() while the board is idle, so a game
+ * waiting for a move uses no CPU. While a piece slides it wakes up once
+ * per TIMESTEP.
+ */
 void mainLoop();
 
-void initPlayers();
-
-void loadTexture(const std::string& name, const std::string& path);
-
+/**
+ * Starts a search for the side to move when the engine plays it, and plays
+ * the move once the search thread is done. Never blocks the frame.
+ */
+void updateEngine();
+
+/**
+ * Takes the last move back (Left or Z) or plays it again (Right or Y).
+ * Against the engine its moves are stepped over as well, so the board is
+ * handed back to the player.
+ */
+void stepHistory(bool forward);
+
+bool parseArgs(int argc, char* argv[]);
+
+/**
+ * The piece a pawn dropped on the last row becomes: a queen, unless
+ * N, B or R is held down.
+ */
+CharacterName promotionChoice();
+
+/**
+ * Maps the bundle next to the executable, else the one the build made.
+ */
+bool openBundle(AssetBundle& bundle);
+
+/**
+ * Packs the sprites, made for the tile size in pixels, into the atlas and
+ * the glyphs of the font into theirs. Both come from the bundle when it
+ * has them, else from the assets directory.
+ */
 void loadTextures();
 
-SDL_Texture* solidText(SDL_Renderer* renderer, const std::string& text, Point2D pos, SDL_Color color);
+/**
+ * Times the frames with one draw call per sprite and with one batch for
+ * all of them, for --render-bench.
+ */
+void renderBench(int frames);
 
 bool init();
 
 
-struct Point2D
-{
-    int x, y;
-};
-
-
-class Character
-{
-
-    friend class King;
-
-protected:
-    Point2D pos{ 0, 0 };
-    Point2D oldPos{ 0, 0 };
-    bool isTop = false;
-    bool isSelected = false;
-    CharacterName name;
-
-    Point2D startPos;
-
-    int point;
-
-    using path_t = std::vector<Point2D>;
-
-public:
-    bool isWhite = false;
-
-    Character(Point2D p, CharacterName _name, bool _isWhite, bool _isTop, int _point);
-
-    void Draw(SDL_Renderer* renderer);
-
-    void SetPos(int x, int y);
-
-    inline int GetPoint() const;
-
-    decltype(pos)& GetPos();
-
-    static path_t GetRookPath(Character& character);
-
-    static path_t GetBishopPath(Character& character);
-
-
-    /**
-     * You should define the path logic for each piece.
-     * By convention, when an enemy is obstructing a path, their position should
-     * be registered as path of the path and must be the end to that path.
-     * 
-     * This will allow the default Move() function to allow capturing that such enemy
-     */
-    virtual std::vector<Point2D> GetPath() = 0;
-
-
-    /**
-     * This method implements the movement logic for the game
-     * @param dest is the destination to move the piece to
-     * 
-     */
-    virtual bool MoveTo(Point2D dest);
-
-    inline CharacterName GetName() const
-    {
-        return name;
-    }
-
-    inline int GetColor() const
-    {
-        return isWhite ? 1 : 0;
-    }
-
-protected:
-    inline bool IsFirstMove() const
-    {
-        return startPos.x == pos.x && startPos.y == pos.y;
-    };
-
-};
-
-
-class Pawn: public Character
-{
-
-public:
-    Pawn(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::PAWN, isWhite, isTop, 1) {};
-    std::vector<Point2D> GetPath();
-};
-
-
-class Rook : public Character
-{
-public:
-    Rook(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::ROOK, isWhite, isTop, 5) {};
-
-    std::vector<Point2D> GetPath();
-};
-
-
-class Knight : public Character
-{
-public:
-    Knight(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::KNIGHT, isWhite, isTop, 3) {};
-
-    std::vector<Point2D> GetPath();
-};
-
-
-class Bishop : public Character
-{
-public:
-    Bishop(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::BISHOP, isWhite, isTop, 3) {};
-
-    std::vector<Point2D> GetPath();
-};
-
-
-class Queen : public Character
-{
-public:
-    Queen(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::QUEEN, isWhite, isTop, 9) {};
-
-    path_t GetPath();
-
-};
-
-
-class King : public Character
-{
-public:
-    King(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::KING, isWhite, isTop, INFINITY) {};
-
-    path_t GetPath();
-
-    bool MoveTo(Point2D dest);
-
-    bool IsInCheck();
-
-private:
-    bool isCastled = false;
-    path_t GetCastlePath();
-};
-
-
-
-class Player
-{
-
-    std::vector<std::unique_ptr<Character>> pieces;
-    int score = 0;
-
-public:
-    bool isWhite = false;
-    
-    Player() = default;
-
-    void Reset(bool _isWhite, bool isTop);
-
-    void Update();
-
-    void Render(SDL_Renderer* renderer);
-
-    std::vector<std::unique_ptr<Character>>::iterator GetPieceAt(Point2D pos);
-
-    //std::unique_ptr<Character>& GetKing() const;
-
-    inline decltype(pieces)& GetPieces()
-    {
-        return pieces;
-    };
-
-    inline int GetColor() const
-    {
-        return isWhite ? 1 : 0;
-    };
-
-    inline void AddScore(int s)
-    {
-        score += s;
-    };
-
-    inline std::string GetName()
-    {
-        return isWhite ? "White" : "Black";
-    };
-
-};
-
-
-class CollisionBoard
-{
-    static std::vector<std::vector<CharacterName>> nameBuffer;
-    static std::vector<std::vector<int>> colorBuffer;
-
-public:
-    static const size_t COL_SIZE = 8;
-    static const size_t ROW_SIZE = 8;
-    static const size_t TILE_SIZE = 64;
-
-    static void Reset();
-
-    static void SetPiece(Character& character);
-
-    static inline CharacterName GetNameAt(int x, int y)
-    {
-        return nameBuffer[y][x];
-    }
-
-    static inline int GetColorAt(int x, int y)
-    {
-        return colorBuffer[y][x];
-    }
-};
-
-
-class Logger
-{
-public:
-    static inline void NextTurn();
-};
-
-#endif 
+#endif
@@ -0,0 +1,177 @@
+/*****************************************************************//**
+ * \file   text.cpp
+ * \brief  Text drawn from a glyph atlas
+ *********************************************************************/
+
+#include "text.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr int ATLAS_WIDTH = 512;
+    // transparent gap between glyphs
+    constexpr int PADDING = 1;
+
+    inline int glyphIndex(char c)
+    {
+        return c >= GlyphAtlas::FIRST_CHAR && c <= GlyphAtlas::LAST_CHAR ? c - GlyphAtlas::FIRST_CHAR : '?' - GlyphAtlas::FIRST_CHAR;
+    }
+}
+
+
+bool GlyphAtlas::Load(SDL_Renderer* renderer, const std::string& fontPath, int pointSize)
+{
+    return Rasterize(renderer, TTF_OpenFont(fontPath.c_str(), pointSize));
+}
+
+
+bool GlyphAtlas::Load(SDL_Renderer* renderer, std::string_view fontData, int pointSize)
+{
+    SDL_RWops* source = SDL_RWFromConstMem(fontData.data(), static_cast<int>(fontData.size()));
+    return Rasterize(renderer, source ? TTF_OpenFontRW(source, 1, pointSize) : nullptr);
+}
+
+
+bool GlyphAtlas::Rasterize(SDL_Renderer* renderer, TTF_Font* font)
+{
+    Destroy();
+
+    if (!font)
+    {
+        SDL_Log("Failed to load font: %s", SDL_GetError());
+        return false;
+    }
+
+    lineHeight = TTF_FontHeight(font);
+
+    // every glyph is rendered as it would be in a line of text, in white so
+    // the vertex color tints it, and packed on shelves left to right
+    SDL_Surface* rendered[GLYPH_NB] = {};
+    int x = PADDING, y = PADDING, shelfHeight = 0;
+    SDL_Color white{ 255, 255, 255, 255 };
+
+    for (int i = 0; i < GLYPH_NB; i++)
+    {
+        auto c = static_cast<Uint16>(FIRST_CHAR + i);
+        int minX, maxX, minY, maxY, advance;
+        if (TTF_GlyphMetrics(font, c, &minX, &maxX, &minY, &maxY, &advance) != 0)
+            continue;
+        glyphs[i].advance = advance;
+
+        // a space only moves the pen
+        if (c == ' ' || !(rendered[i] = TTF_RenderGlyph_Blended(font, c, white)))
+            continue;
+
+        if (x + rendered[i]->w + PADDING > ATLAS_WIDTH)
+        {
+            x = PADDING;
+            y += shelfHeight + PADDING;
+            shelfHeight = 0;
+        }
+        glyphs[i].source = { x, y, rendered[i]->w, rendered[i]->h };
+        x += rendered[i]->w + PADDING;
+        shelfHeight = std::max(shelfHeight, rendered[i]->h);
+    }
+
+    kerning.assign(GLYPH_NB * GLYPH_NB, 0);
+    for (int a = 0; a < GLYPH_NB; a++)
+        for (int b = 0; b < GLYPH_NB; b++)
+            kerning[a * GLYPH_NB + b] = static_cast<int8_t>(TTF_GetFontKerningSizeGlyphs(font, static_cast<Uint16>(FIRST_CHAR + a), static_cast<Uint16>(FIRST_CHAR + b)));
+    TTF_CloseFont(font);
+
+    width = ATLAS_WIDTH;
+    height = y + shelfHeight + PADDING;
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+
+    for (int i = 0; i < GLYPH_NB; i++)
+    {
+        if (!rendered[i])
+            continue;
+
+        // copied as they are, alpha included
+        if (sheet)
+        {
+            SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered[i], nullptr, sheet, &glyphs[i].source);
+        }
+        SDL_FreeSurface(rendered[i]);
+    }
+
+    if (!sheet)
+    {
+        SDL_Log("Failed to create the glyph atlas: %s", SDL_GetError());
+        return false;
+    }
+
+    texture = SDL_CreateTextureFromSurface(renderer, sheet);
+    SDL_FreeSurface(sheet);
+    if (!texture)
+    {
+        SDL_Log("Failed to create the glyph atlas: %s", SDL_GetError());
+        return false;
+    }
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+
+void GlyphAtlas::Destroy()
+{
+    if (texture)
+        SDL_DestroyTexture(texture);
+    texture = nullptr;
+    layouts.clear();
+}
+
+
+const std::vector<GlyphAtlas::PlacedGlyph>& GlyphAtlas::Layout(std::string_view line)
+{
+    auto found = layouts.find(line);
+    if (found != layouts.end())
+        return found->second;
+
+    // lines that keep changing, like a clock, would otherwise pile up
+    if (layouts.size() >= MAX_LAYOUTS)
+        layouts.clear();
+
+    std::vector<PlacedGlyph> placed;
+    int pen = 0, previous = -1;
+
+    for (char c : line)
+    {
+        int i = glyphIndex(c);
+        if (previous >= 0)
+            pen += kerning[previous * GLYPH_NB + i];
+
+        const Glyph& glyph = glyphs[i];
+        if (glyph.source.w > 0)
+            placed.push_back({ glyph.source, { pen, 0, glyph.source.w, glyph.source.h } });
+
+        pen += glyph.advance;
+        previous = i;
+    }
+
+    return layouts.emplace(std::string(line), std::move(placed)).first->second;
+}
+
+
+void GlyphAtlas::Add(SpriteBatch& batch, std::string_view text, int x, int y, SDL_Color color)
+{
+    if (!texture)
+        return;
+
+    while (true)
+    {
+        size_t end = std::min(text.find('\n'), text.size());
+
+        for (const auto& glyph : Layout(text.substr(0, end)))
+            batch.Add(glyph.source, { x + glyph.dest.x, y + glyph.dest.y, glyph.dest.w, glyph.dest.h }, color);
+
+        if (end == text.size())
+            break;
+        text.remove_prefix(end + 1);
+        y += lineHeight;
+    }
+}
@@ -0,0 +1,115 @@
+/*****************************************************************//**
+ * \file   text.hpp
+ * \brief  Text drawn from a glyph atlas
+ *
+ * The printable ASCII glyphs of a font are rasterized once, in white, into
+ * one texture. A line is laid out into glyph quads the first time it is
+ * drawn and the layout is kept, keyed by the line's content, so drawing it
+ * again is a hash lookup and a copy of its quads into a SpriteBatch. The
+ * color comes from the vertices, one layout serves every color, and a
+ * whole panel of text is one draw call without any texture upload.
+ *********************************************************************/
+#pragma once
+#ifndef __BYTENOL_CHESS_TEXT_HPP__
+#define __BYTENOL_CHESS_TEXT_HPP__
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "atlas.hpp"
+
+#include <SDL2/SDL_ttf.h>
+
+
+class GlyphAtlas
+{
+public:
+    static constexpr char FIRST_CHAR = ' ';
+    static constexpr char LAST_CHAR = '~';
+    static constexpr int GLYPH_NB = LAST_CHAR - FIRST_CHAR + 1;
+
+    // more distinct lines than this and the layouts start over
+    static constexpr size_t MAX_LAYOUTS = 1024;
+
+    /**
+     * Rasterizes the glyphs of the font at the size, false when the font
+     * cannot be opened or the atlas cannot be made.
+     */
+    bool Load(SDL_Renderer* renderer, const std::string& fontPath, int pointSize);
+
+    /**
+     * The same from a font file already in memory, which is only read
+     * while loading.
+     */
+    bool Load(SDL_Renderer* renderer, std::string_view fontData, int pointSize);
+
+    void Destroy();
+
+    /**
+     * Adds the text with its top left corner at (x, y) to the batch, lines
+     * break at '\n'. Characters outside printable ASCII show as '?'.
+     */
+    void Add(SpriteBatch& batch, std::string_view text, int x, int y, SDL_Color color);
+
+    /**
+     * Draws a batch filled by Add().
+     */
+    inline void Draw(SDL_Renderer* renderer, SpriteBatch& batch, bool batched = true) const
+    {
+        batch.Draw(renderer, texture, width, height, batched);
+    }
+
+    inline int GetLineHeight() const
+    {
+        return lineHeight;
+    }
+
+    inline size_t GetCachedLines() const
+    {
+        return layouts.size();
+    }
+
+private:
+    struct Glyph
+    {
+        SDL_Rect source{ 0, 0, 0, 0 };
+        int advance = 0;
+    };
+
+    struct PlacedGlyph
+    {
+        SDL_Rect source;
+        // relative to the start of the line
+        SDL_Rect dest;
+    };
+
+    // lets the layouts be looked up by string_view without making a string
+    struct LineHash
+    {
+        using is_transparent = void;
+
+        inline size_t operator()(std::string_view line) const
+        {
+            return std::hash<std::string_view>{}(line);
+        }
+    };
+
+    SDL_Texture* texture = nullptr;
+    int width = 0, height = 0;
+    int lineHeight = 0;
+
+    Glyph glyphs[GLYPH_NB];
+    // kerning between two glyphs, first glyph major
+    std::vector<int8_t> kerning;
+
+    std::unordered_map<std::string, std::vector<PlacedGlyph>, LineHash, std::equal_to<>> layouts;
+
+    // takes the font and closes it
+    bool Rasterize(SDL_Renderer* renderer, TTF_Font* font);
+
+    const std::vector<PlacedGlyph>& Layout(std::string_view line);
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*****************************************************************//**
+ * \file   bench.cpp
+ * \brief  Parallel search scaling benchmark
+ *
+ * Searches a fixed set of positions to a fixed depth with 1, 2, 4, 8 and
+ * 16 threads (or the counts given) and reports the time to depth, the
+ * speedup over one thread and the nodes per second.
+ *
+ *  chess_bench [--depth n] [--threads 1,2,4,8,16] [--hash mb]
+ *
+ * Every run starts from an empty hash table and fresh workers, so the
+ * numbers do not depend on the order of the runs. Lazy SMP is not
+ * deterministic, expect a few percent of noise between runs.
+ *********************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "search.hpp"
+
+const char* BENCH_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+
+struct BenchResult
+{
+    double seconds = 0;
+    uint64_t nodes = 0;
+};
+
+
+BenchResult runBench(int threads, int depth, size_t hashMb)
+{
+    BenchResult result;
+    TranspositionTable table(hashMb);
+    SearchPool pool(table, threads);
+
+    Search::Limits limits;
+    limits.depth = depth;
+
+    for (auto fen : BENCH_POSITIONS)
+    {
+        Position position;
+        position.SetFen(fen);
+
+        auto start = std::chrono::steady_clock::now();
+        auto info = pool.Run(position, limits);
+        result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.nodes += info.nodes;
+    }
+
+    return result;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int depth = 12;
+    size_t hashMb = 64;
+    std::vector<int> threadCounts = { 1, 2, 4, 8, 16 };
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if (!std::strcmp(argv[i], "--depth") && hasValue) depth = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--hash") && hasValue) hashMb = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--threads") && hasValue)
+        {
+            threadCounts.clear();
+            std::istringstream list(argv[++i]);
+            for (std::string n; std::getline(list, n, ',');)
+                threadCounts.push_back(std::max(1, std::atoi(n.c_str())));
+        }
+        else
+        {
+            std::cerr << "usage: chess_bench [--depth n] [--threads 1,2,4,8,16] [--hash mb]" << std::endl;
+            return 2;
+        }
+    }
+
+    Attacks::Init();
+
+    std::cout << "depth " << depth << ", " << std::size(BENCH_POSITIONS) << " positions, "
+        << hashMb << " MB hash, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(10) << "time(s)" << std::setw(14) << "nodes"
+        << std::setw(12) << "nps" << std::setw(10) << "speedup" << std::setw(10) << "nps x" << std::endl;
+
+    double baseSeconds = 0, baseNps = 0;
+    for (int threads : threadCounts)
+    {
+        auto result = runBench(threads, depth, hashMb);
+        double nps = result.seconds > 0 ? result.nodes / result.seconds : 0;
+
+        if (baseSeconds == 0)
+        {
+            baseSeconds = result.seconds;
+            baseNps = nps;
+        }
+
+        std::cout << std::setw(8) << threads
+            << std::setw(10) << std::fixed << std::setprecision(3) << result.seconds
+            << std::setw(14) << result.nodes
+            << std::setw(12) << static_cast<uint64_t>(nps)
+            << std::setw(10) << std::setprecision(2) << baseSeconds / result.seconds
+            << std::setw(10) << (baseNps > 0 ? nps / baseNps : 0) << std::endl;
+    }
+
+    return 0;
+}
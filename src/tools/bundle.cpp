@@ -0,0 +1,111 @@
+/*****************************************************************//**
+ * \file   bundle.cpp
+ * \brief  Packs the game's assets into one bundle, run by the build
+ *
+ *  chess_bundle assets/ assets.bundle 64 128
+ *
+ * The sprites are decoded and scaled to an atlas sheet for each cell size
+ * given, the tile size at the display scales the game should start fast
+ * on, and stored as raw RGBA with the font file next to them. The game
+ * maps the bundle and makes its textures straight from it, any other
+ * scale still loads from the PNGs.
+ *********************************************************************/
+
+#define SDL_MAIN_HANDLED
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <SDL2/SDL_image.h>
+
+#include "bundle.hpp"
+#include "atlas.hpp"
+
+
+int writeBundle(const std::string& assets, const char* path, const std::vector<int>& cellSizes)
+{
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto start = std::chrono::steady_clock::now();
+    BundleWriter writer;
+
+    for (int cellSize : cellSizes)
+    {
+        SDL_Surface* sheet = SpriteAtlas::Compose(assets + Assets::SPRITES, cellSize, threads);
+        if (!sheet)
+            return 1;
+
+        // the rows without whatever padding the surface has
+        std::string pixels;
+        pixels.reserve(static_cast<size_t>(sheet->w) * sheet->h * 4);
+        for (int y = 0; y < sheet->h; y++)
+            pixels.append(static_cast<const char*>(sheet->pixels) + static_cast<size_t>(y) * sheet->pitch, static_cast<size_t>(sheet->w) * 4);
+
+        std::cout << Assets::SheetEntry(cellSize) << ": " << sheet->w << "x" << sheet->h
+            << " from " << chooseSpriteSet(cellSize).directory << std::endl;
+        writer.Add(Assets::SheetEntry(cellSize), std::move(pixels), sheet->w, sheet->h);
+        SDL_FreeSurface(sheet);
+    }
+
+    std::ifstream font(assets + Assets::FONT, std::ios::binary);
+    if (!font)
+    {
+        std::cerr << "cannot read " << assets + Assets::FONT << std::endl;
+        return 1;
+    }
+    std::ostringstream fontData;
+    fontData << font.rdbuf();
+    writer.Add(Assets::FONT_ENTRY, fontData.str());
+
+    if (!writer.Write(path))
+    {
+        std::cerr << "cannot write " << path << std::endl;
+        return 1;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "wrote " << path << " in " << ms << " ms" << std::endl;
+    return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        std::cerr << "usage: chess_bundle assets/ out.bundle cellsize..." << std::endl;
+        return 2;
+    }
+
+    std::string assets = argv[1];
+    if (!assets.empty() && assets.back() != '/')
+        assets += '/';
+
+    std::vector<int> cellSizes;
+    for (int i = 3; i < argc; i++)
+    {
+        cellSizes.push_back(std::atoi(argv[i]));
+        if (cellSizes.back() <= 0)
+        {
+            std::cerr << "invalid cell size " << argv[i] << std::endl;
+            return 2;
+        }
+    }
+
+    // the PNG loader is set up lazily and not thread safe, so before the workers load
+    if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG))
+    {
+        std::cerr << "SDL_image init failed: " << IMG_GetError() << std::endl;
+        return 1;
+    }
+
+    int status = writeBundle(assets, argv[2], cellSizes);
+    IMG_Quit();
+    return status;
+}
@@ -0,0 +1,157 @@
+/*****************************************************************//**
+ * \file   fen_bench.cpp
+ * \brief  FEN parsing and writing throughput
+ *
+ * Loads a set of positions as FEN over and over and reports positions per
+ * second for Position::SetFen() and Position::WriteFen(), then checks that
+ * every position reads back to the same text and key.
+ *
+ *  chess_fen_bench [--file fens.txt] [--positions n] [--rounds n]
+ *
+ * Without a file the positions come from random games played from a few
+ * known openings and endgames, with a fixed seed so runs are comparable.
+ *********************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+
+#include "position.hpp"
+#include "movegen.hpp"
+
+const char* SEED_POSITIONS[] = {
+    Position::START_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+
+std::vector<std::string> randomPositions(size_t count)
+{
+    std::vector<std::string> fens;
+    fens.reserve(count);
+
+    std::mt19937 rng(2025);
+    Position position;
+    MoveList moves;
+
+    while (fens.size() < count)
+    {
+        position.SetFen(SEED_POSITIONS[fens.size() % std::size(SEED_POSITIONS)]);
+
+        for (int ply = 0; ply < 120 && fens.size() < count; ply++)
+        {
+            moves.Clear();
+            generateLegal(position, moves);
+            if (moves.Empty())
+                break;
+
+            position.MakeMove(moves[rng() % moves.Size()]);
+            fens.push_back(position.GetFen());
+        }
+    }
+
+    return fens;
+}
+
+
+std::vector<std::string> readPositions(const char* path)
+{
+    std::vector<std::string> fens;
+    std::ifstream file(path);
+
+    for (std::string line; std::getline(file, line);)
+        if (!line.empty())
+            fens.push_back(line);
+
+    return fens;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* path = nullptr;
+    size_t count = 100000;
+    int rounds = 10;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if (!std::strcmp(argv[i], "--file") && hasValue) path = argv[++i];
+        else if (!std::strcmp(argv[i], "--positions") && hasValue) count = std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--rounds") && hasValue) rounds = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            std::cerr << "usage: chess_fen_bench [--file fens.txt] [--positions n] [--rounds n]" << std::endl;
+            return 2;
+        }
+    }
+
+    Attacks::Init();
+
+    auto fens = path ? readPositions(path) : randomPositions(count);
+    if (fens.empty())
+    {
+        std::cerr << "no positions" << std::endl;
+        return 1;
+    }
+
+    Position position;
+    uint64_t checksum = 0;
+    size_t invalid = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        for (const auto& fen : fens)
+        {
+            invalid += !position.SetFen(fen);
+            checksum ^= position.GetKey();
+        }
+    double parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // writing one position over and over would only measure the cache, so parse them first
+    std::vector<Position> positions(std::min<size_t>(fens.size(), 10000));
+    for (size_t i = 0; i < positions.size(); i++)
+        positions[i].SetFen(fens[i]);
+
+    char buffer[Position::FEN_CAPACITY];
+    size_t written = 0;
+    size_t writes = static_cast<size_t>(rounds) * fens.size();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < writes; i++)
+        written += positions[i % positions.size()].WriteFen(buffer);
+    double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // what is written must read back to the same position
+    size_t mismatches = 0;
+    Position again;
+    for (const auto& fen : fens)
+    {
+        if (!position.SetFen(fen))
+            continue;
+
+        size_t length = position.WriteFen(buffer);
+        if (!again.SetFen(std::string_view(buffer, length)) || again.GetKey() != position.GetKey()
+            || again.GetFen() != std::string_view(buffer, length))
+            mismatches++;
+    }
+
+    double parsed = static_cast<double>(rounds) * fens.size();
+    std::cout << fens.size() << " positions x " << rounds << " rounds, " << invalid / rounds << " invalid" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+        << "SetFen    " << std::setw(12) << static_cast<uint64_t>(parsed / parseSeconds) << " positions/s "
+        << std::setw(8) << parseSeconds * 1e9 / parsed << " ns each" << std::endl
+        << "WriteFen  " << std::setw(12) << static_cast<uint64_t>(writes / writeSeconds) << " positions/s "
+        << std::setw(8) << writeSeconds * 1e9 / writes << " ns each" << std::endl;
+    std::cout << "round trip mismatches " << mismatches << " (checksum " << std::hex << (checksum ^ written) << ")" << std::endl;
+
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/*****************************************************************//**
+ * \file   gamelog.cpp
+ * \brief  Binary game log conversion and scan speed
+ *
+ *  chess_log topgn game.cgl [out.pgn]     writes the games as PGN, to stdout without a file
+ *  chess_log frompgn games.pgn game.cgl   appends the games of a PGN to the log
+ *  chess_log scan game.cgl                counts games and moves, checks every game
+ *                                         and reports the speed of both
+ *
+ * The scan walks the move words of every game without playing them, the
+ * check replays each game through the rules against its checkpoints.
+ *********************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+
+#include "gamelog.hpp"
+
+
+int scan(const char* path)
+{
+    GameLogReader reader;
+    if (!reader.Open(path))
+    {
+        std::cerr << "cannot read " << path << std::endl;
+        return 1;
+    }
+
+    GameRecord game;
+    uint64_t games = 0, moves = 0, unfinished = 0, checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    while (reader.Next(game))
+    {
+        games++;
+        unfinished += !game.finished;
+        game.ForEachMove([&](Move m)
+        {
+            checksum += m.Raw();
+            moves++;
+        });
+    }
+    double scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Position position;
+    uint64_t damaged = 0;
+
+    reader.Seek(0);
+    start = std::chrono::steady_clock::now();
+    while (reader.Next(game))
+        damaged += !game.Replay(position);
+    double replaySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double megabytes = reader.Size() / (1024.0 * 1024.0);
+    std::cout << path << ": " << games << " games (" << unfinished << " unfinished, " << damaged << " damaged), "
+        << moves << " moves, " << std::fixed << std::setprecision(1) << megabytes << " MB, "
+        << (games ? static_cast<double>(reader.Size()) / games : 0) << " bytes per game" << std::endl;
+    std::cout << "scan    " << std::setw(8) << std::setprecision(3) << scanSeconds << " s "
+        << std::setw(10) << std::setprecision(1) << megabytes / scanSeconds << " MB/s "
+        << std::setw(12) << static_cast<uint64_t>(games / scanSeconds) << " games/s" << std::endl;
+    std::cout << "replay  " << std::setw(8) << std::setprecision(3) << replaySeconds << " s "
+        << std::setw(10) << std::setprecision(1) << megabytes / replaySeconds << " MB/s "
+        << std::setw(12) << static_cast<uint64_t>(games / replaySeconds) << " games/s"
+        << " (checksum " << checksum << ")" << std::endl;
+
+    return damaged ? 1 : 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    Attacks::Init();
+
+    if (argc >= 3 && !std::strcmp(argv[1], "topgn"))
+    {
+        long long games;
+        if (argc >= 4)
+        {
+            std::ofstream out(argv[3], std::ios::binary);
+            games = out ? gameLogToPgn(argv[2], out) : -1;
+        }
+        else
+            games = gameLogToPgn(argv[2], std::cout);
+
+        if (games < 0)
+        {
+            std::cerr << "cannot convert " << argv[2] << std::endl;
+            return 1;
+        }
+        std::cerr << games << " games" << std::endl;
+        return 0;
+    }
+
+    if (argc >= 4 && !std::strcmp(argv[1], "frompgn"))
+    {
+        auto start = std::chrono::steady_clock::now();
+        long long games = pgnToGameLog(argv[2], argv[3]);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (games < 0)
+        {
+            std::cerr << "cannot convert " << argv[2] << " to " << argv[3] << std::endl;
+            return 1;
+        }
+        std::cerr << games << " games in " << std::fixed << std::setprecision(3) << seconds << " s" << std::endl;
+        return 0;
+    }
+
+    if (argc >= 3 && !std::strcmp(argv[1], "scan"))
+        return scan(argv[2]);
+
+    std::cerr << "usage: chess_log topgn game.cgl [out.pgn]" << std::endl
+        << "       chess_log frompgn games.pgn game.cgl" << std::endl
+        << "       chess_log scan game.cgl" << std::endl;
+    return 2;
+}
@@ -0,0 +1,231 @@
+/*****************************************************************//**
+ * \file   perft.cpp
+ * \brief  Move generation node counter
+ *
+ * Counts the leaf nodes of the legal move tree to a fixed depth, which
+ * checks movegen against known totals and measures its speed.
+ *
+ *  chess_perft [--fen "<fen>"] [--depth n] [--threads n] [--hash mb] [--divide]
+ *  chess_perft --suite [--threads n] [--hash mb]
+ *
+ * Root moves are shared out to the worker threads. With --hash, all
+ * threads share a transposition table of subtree counts so transpositions
+ * are only walked once.
+ *********************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#include "position.hpp"
+#include "movegen.hpp"
+#include "notation.hpp"
+#include "tt.hpp"
+
+
+struct PerftCase
+{
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+// the usual reference positions: start, "Kiwipete", and castling, en passant and promotion corner cases
+const PerftCase SUITE[] = {
+    { Position::START_FEN, 5, 4865609 },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603 },
+    { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624 },
+    { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333 },
+    { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487 },
+    { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594 },
+    { "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467 },
+    { "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888 },
+    { "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133 },
+    { "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584 },
+    { "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683 },
+    { "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217 },
+    { "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342 },
+    { "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206 },
+    { "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476 },
+    { "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001 },
+    { "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658 },
+    { "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072 },
+    { "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711 },
+    { "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527 },
+};
+
+
+uint64_t perft(Position& position, int depth, TranspositionTable& table)
+{
+    MoveList list;
+    generateLegal(position, list);
+
+    if (depth <= 1)
+        return depth == 1 ? list.Size() : 1;
+
+    TranspositionTable::Data data;
+    if (table.Enabled() && table.Probe(position.GetKey(), data) && data.depth == depth)
+        return data.payload;
+
+    uint64_t nodes = 0;
+    for (auto m : list)
+    {
+        position.MakeMove(m);
+        nodes += perft(position, depth - 1, table);
+        position.UnmakeMove();
+    }
+
+    if (table.Enabled() && nodes <= TranspositionTable::PAYLOAD_MASK)
+        table.Store(position.GetKey(), depth, TranspositionTable::BOUND_EXACT, nodes);
+
+    return nodes;
+}
+
+
+struct PerftResult
+{
+    uint64_t nodes = 0;
+    double seconds = 0;
+    std::vector<std::pair<Move, uint64_t>> divide;
+};
+
+
+PerftResult runPerft(const Position& root, int depth, int threads, TranspositionTable& table)
+{
+    PerftResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    Position position = root;
+    MoveList moves;
+    generateLegal(position, moves);
+
+    std::vector<uint64_t> counts(moves.Size(), 0);
+    std::atomic<size_t> next{ 0 };
+
+    auto worker = [&]() {
+        Position local = root;
+
+        for (size_t i = next++; i < moves.Size(); i = next++)
+        {
+            local.MakeMove(moves[i]);
+            counts[i] = perft(local, depth - 1, table);
+            local.UnmakeMove();
+        }
+    };
+
+    if (depth > 0)
+    {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; t++)
+            pool.emplace_back(worker);
+        for (auto& t : pool)
+            t.join();
+
+        for (size_t i = 0; i < moves.Size(); i++)
+        {
+            result.nodes += counts[i];
+            result.divide.push_back({ moves[i], counts[i] });
+        }
+    }
+    else
+        result.nodes = 1;
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+
+void printStats(uint64_t nodes, double seconds)
+{
+    std::cout << "Nodes: " << nodes
+        << "  Time: " << std::fixed << std::setprecision(3) << seconds << "s"
+        << "  NPS: " << static_cast<uint64_t>(seconds > 0 ? nodes / seconds : 0) << std::endl;
+}
+
+
+int runSuite(int threads, TranspositionTable& table)
+{
+    int failed = 0;
+    uint64_t total = 0;
+    double seconds = 0;
+
+    for (const auto& test : SUITE)
+    {
+        Position position;
+        position.SetFen(test.fen);
+
+        table.Clear();
+        auto result = runPerft(position, test.depth, threads, table);
+        bool ok = result.nodes == test.nodes;
+        failed += !ok;
+        total += result.nodes;
+        seconds += result.seconds;
+
+        std::cout << (ok ? "ok    " : "FAIL  ") << "depth " << test.depth << "  " << std::setw(10) << result.nodes;
+        if (!ok)
+            std::cout << " (expected " << test.nodes << ")";
+        std::cout << "  " << test.fen << std::endl;
+    }
+
+    printStats(total, seconds);
+    std::cout << failed << " of " << std::size(SUITE) << " positions failed" << std::endl;
+    return failed ? 1 : 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::string fen = Position::START_FEN;
+    int depth = 5;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t hashMb = 0;
+    bool divide = false, suite = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--fen" && hasValue) fen = argv[++i];
+        else if (arg == "--depth" && hasValue) depth = std::atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--hash" && hasValue) hashMb = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--divide") divide = true;
+        else if (arg == "--suite") suite = true;
+        else
+        {
+            std::cerr << "usage: chess_perft [--fen \"<fen>\"] [--depth n] [--threads n] [--hash mb] [--divide] [--suite]" << std::endl;
+            return 2;
+        }
+    }
+
+    Attacks::Init();
+    TranspositionTable table(hashMb);
+
+    if (suite)
+        return runSuite(threads, table);
+
+    Position position;
+    if (!position.SetFen(fen))
+    {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return 2;
+    }
+
+    auto result = runPerft(position, depth, threads, table);
+
+    if (divide)
+    {
+        for (auto& [move, nodes] : result.divide)
+            std::cout << moveToString(move) << ": " << nodes << std::endl;
+        std::cout << std::endl;
+    }
+
+    printStats(result.nodes, result.seconds);
+    return 0;
+}
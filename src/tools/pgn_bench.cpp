@@ -0,0 +1,162 @@
+/*****************************************************************//**
+ * \file   pgn_bench.cpp
+ * \brief  PGN reading throughput
+ *
+ * Replays every game of a PGN file through the rules with 1, 2, 4 and 8
+ * threads (or the counts given) and reports games, positions and
+ * megabytes per second.
+ *
+ *  chess_pgn_bench [--threads 1,2,4,8] [--generate games] file.pgn
+ *
+ * --generate first writes that many random games to the file, with
+ * comments, variations and annotations so every part of the tokenizer
+ * is used. The file stays mapped for all runs, so after the first run it
+ * is read from the page cache.
+ *********************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "pgn.hpp"
+#include "mappedfile.hpp"
+
+
+bool generateGames(const char* path, int games)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+
+    std::mt19937 rng(2025);
+    Position position;
+    MoveList moves;
+
+    for (int g = 0; g < games; g++)
+    {
+        position.SetStartPosition();
+
+        std::string text;
+        const char* result = "*";
+
+        for (int ply = 0; ply < 160; ply++)
+        {
+            moves.Clear();
+            generateLegal(position, moves);
+            if (moves.Empty())
+            {
+                result = !position.InCheck() ? "1/2-1/2" : position.GetSideToMove() == WHITE ? "0-1" : "1-0";
+                break;
+            }
+
+            Move m = moves[rng() % moves.Size()];
+            if (ply % 2 == 0)
+                text += std::to_string(ply / 2 + 1) + ". ";
+            text += moveToSan(position, m);
+
+            // a sprinkle of what real files have between the moves
+            switch (rng() % 64)
+            {
+            case 0: text += " {a comment (with parentheses)}"; break;
+            case 1: text += " $1"; break;
+            case 2: text += " (" + std::to_string(ply / 2 + 1) + (ply % 2 ? "... " : ". ") + moveToSan(position, moves[0]) + " {sideline})"; break;
+            default: break;
+            }
+
+            text += ply % 16 == 15 ? '\n' : ' ';
+            position.MakeMove(m);
+        }
+
+        out << "[Event \"Random game\"]\n[Site \"?\"]\n[Round \"" << g + 1 << "\"]\n"
+            << "[White \"random\"]\n[Black \"random\"]\n[Result \"" << result << "\"]\n\n"
+            << text << result << "\n\n";
+    }
+
+    return static_cast<bool>(out);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const char* path = nullptr;
+    int generate = 0;
+    std::vector<int> threadCounts = { 1, 2, 4, 8 };
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if (!std::strcmp(argv[i], "--generate") && hasValue) generate = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--threads") && hasValue)
+        {
+            threadCounts.clear();
+            std::istringstream list(argv[++i]);
+            for (std::string n; std::getline(list, n, ',');)
+                threadCounts.push_back(std::max(1, std::atoi(n.c_str())));
+        }
+        else if (argv[i][0] != '-' && !path) path = argv[i];
+        else
+            path = nullptr, i = argc;
+    }
+
+    if (!path)
+    {
+        std::cerr << "usage: chess_pgn_bench [--threads 1,2,4,8] [--generate games] file.pgn" << std::endl;
+        return 2;
+    }
+
+    Attacks::Init();
+
+    if (generate > 0 && !generateGames(path, generate))
+    {
+        std::cerr << "cannot write " << path << std::endl;
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        std::cerr << "cannot open " << path << std::endl;
+        return 1;
+    }
+
+    double megabytes = file.Size() / (1024.0 * 1024.0);
+    std::cout << path << ", " << std::fixed << std::setprecision(1) << megabytes << " MB, "
+        << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(10) << "time(s)" << std::setw(10) << "games"
+        << std::setw(12) << "positions" << std::setw(8) << "errors" << std::setw(12) << "games/s"
+        << std::setw(14) << "positions/s" << std::setw(10) << "MB/s" << std::endl;
+
+    for (int threads : threadCounts)
+    {
+        // a little work per position, so the replay cannot be skipped
+        std::atomic<uint64_t> checksum{ 0 };
+        auto callback = [&checksum](const PgnGame&, const Position& position, Move move)
+        {
+            if (!move)
+                checksum.fetch_xor(position.GetKey(), std::memory_order_relaxed);
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        auto stats = readPgn(file.View(), callback, threads);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::setw(8) << threads
+            << std::setw(10) << std::setprecision(3) << seconds
+            << std::setw(10) << stats.games
+            << std::setw(12) << stats.positions
+            << std::setw(8) << stats.errors
+            << std::setw(12) << static_cast<uint64_t>(stats.games / seconds)
+            << std::setw(14) << static_cast<uint64_t>(stats.positions / seconds)
+            << std::setw(10) << std::setprecision(1) << megabytes / seconds << std::endl;
+    }
+
+    return 0;
+}
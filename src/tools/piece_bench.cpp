@@ -0,0 +1,364 @@
+/*****************************************************************//**
+ * \file   piece_bench.cpp
+ * \brief  The players' PieceSet against the Character objects it replaced
+ *
+ * The old hierarchy, one heap object per piece behind a virtual GetPath(),
+ * is kept below as it was, reading the collision board the same way. Both
+ * are timed on the start position for
+ *
+ *  setup   Reset() of both players, a new game
+ *  scan    a walk over the 32 pieces reading name, color and square, what
+ *          drawing the board and stamping the position do every time
+ *  moves   every move of the side to move: one GetPath() per piece for the
+ *          old classes, one generatePseudoLegal() now
+ *
+ *  chess_piece_bench [--rounds n]
+ *********************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#include "game.hpp"
+#include "movegen.hpp"
+
+
+namespace Legacy
+{
+    class Character
+    {
+    protected:
+        Point2D pos{ 0, 0 };
+        Point2D oldPos{ 0, 0 };
+        bool isTop = false;
+        bool isSelected = false;
+        bool isActive = true;
+        CharacterName name;
+        Point2D startPos;
+        int point;
+
+    public:
+        using path_t = MoveList;
+
+        bool isWhite = false;
+
+        Character(Point2D p, CharacterName _name, bool _isWhite, bool _isTop, int _point) :
+            pos(p), isTop(_isTop), name(_name), startPos(p), point(_point), isWhite(_isWhite)
+        {
+        }
+
+        virtual ~Character() = default;
+
+        virtual path_t GetPath() = 0;
+
+        inline Point2D& GetPos()
+        {
+            return pos;
+        }
+
+        inline CharacterName GetName() const
+        {
+            return name;
+        }
+
+        inline int GetColor() const
+        {
+            return isWhite ? 1 : 0;
+        }
+
+        inline bool IsActive() const
+        {
+            return isActive;
+        }
+
+    protected:
+        inline int Square() const
+        {
+            return MakeSquare(pos.x, pos.y);
+        }
+
+        inline bool IsFirstMove() const
+        {
+            return startPos.x == pos.x && startPos.y == pos.y;
+        }
+
+        static void AddMoves(path_t& path, int from, Bitboard targets)
+        {
+            Bitboard occupied = CollisionBoard::GetOccupied();
+            while (targets)
+            {
+                int to = PopLsb(targets);
+                path.Add(Move(from, to, TestBit(occupied, to) ? Move::CAPTURE : Move::QUIET));
+            }
+        }
+
+        inline Bitboard NotOwn() const
+        {
+            return ~CollisionBoard::GetColorPieces(GetColor());
+        }
+    };
+
+
+    class Pawn : public Character
+    {
+    public:
+        Pawn(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::PAWN, isWhite, isTop, 1) {}
+
+        path_t GetPath() override
+        {
+            path_t v;
+            int sq = Square(), color = GetColor();
+            Bitboard empty = ~CollisionBoard::GetOccupied();
+
+            Bitboard push = Attacks::PAWN_PUSH[color][sq] & empty;
+            if (push)
+            {
+                int to = Lsb(push);
+                v.Add(Move(sq, to));
+
+                Bitboard doublePush = Attacks::PAWN_PUSH[color][to] & empty;
+                if (doublePush && IsFirstMove())
+                    v.Add(Move(sq, Lsb(doublePush), Move::DOUBLE_PUSH));
+            }
+
+            AddMoves(v, sq, Attacks::Pawn(color, sq) & CollisionBoard::GetColorPieces(1 - color));
+            return v;
+        }
+    };
+
+
+    class Rook : public Character
+    {
+    public:
+        Rook(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::ROOK, isWhite, isTop, 5) {}
+
+        path_t GetPath() override
+        {
+            path_t v;
+            AddMoves(v, Square(), Attacks::Rook(Square(), CollisionBoard::GetOccupied()) & NotOwn());
+            return v;
+        }
+    };
+
+
+    class Knight : public Character
+    {
+    public:
+        Knight(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::KNIGHT, isWhite, isTop, 3) {}
+
+        path_t GetPath() override
+        {
+            path_t v;
+            AddMoves(v, Square(), Attacks::Knight(Square()) & NotOwn());
+            return v;
+        }
+    };
+
+
+    class Bishop : public Character
+    {
+    public:
+        Bishop(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::BISHOP, isWhite, isTop, 3) {}
+
+        path_t GetPath() override
+        {
+            path_t v;
+            AddMoves(v, Square(), Attacks::Bishop(Square(), CollisionBoard::GetOccupied()) & NotOwn());
+            return v;
+        }
+    };
+
+
+    class Queen : public Character
+    {
+    public:
+        Queen(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::QUEEN, isWhite, isTop, 9) {}
+
+        path_t GetPath() override
+        {
+            path_t v;
+            AddMoves(v, Square(), Attacks::Queen(Square(), CollisionBoard::GetOccupied()) & NotOwn());
+            return v;
+        }
+    };
+
+
+    class King : public Character
+    {
+    public:
+        King(Point2D p, bool isWhite, bool isTop) : Character(p, CharacterName::KING, isWhite, isTop, 0) {}
+
+        path_t GetPath() override
+        {
+            path_t v;
+            int sq = Square();
+            AddMoves(v, sq, Attacks::King(sq) & NotOwn());
+
+            if (IsFirstMove())
+                for (bool kingSide : { false, true })
+                    if (CollisionBoard::GetPosition().CanCastle(GetColor(), kingSide))
+                        v.Add(Move(sq, Position::CastleDestination(GetColor(), kingSide), kingSide ? Move::KING_CASTLE : Move::QUEEN_CASTLE));
+            return v;
+        }
+    };
+
+
+    class Player
+    {
+        std::vector<std::unique_ptr<Character>> pieces;
+        Character* squares[SQUARE_NB] = {};
+
+    public:
+        void Reset(bool isWhite, bool isTop)
+        {
+            pieces.clear();
+
+            int topOffset = isTop ? 1 : -1;
+            int startY = isTop ? 0 : CollisionBoard::ROW_SIZE - 1;
+
+            for (int x = 0; x < static_cast<int>(CollisionBoard::COL_SIZE); x++)
+                pieces.push_back(std::make_unique<Pawn>(Point2D{ x, startY + topOffset }, isWhite, isTop));
+
+            for (int i = 0; i < 2; i++)
+            {
+                int side = i == 0 ? 0 : CollisionBoard::COL_SIZE - 1;
+                int step = i == 0 ? 1 : -1;
+                pieces.push_back(std::make_unique<Rook>(Point2D{ side, startY }, isWhite, isTop));
+                pieces.push_back(std::make_unique<Knight>(Point2D{ side + step, startY }, isWhite, isTop));
+                pieces.push_back(std::make_unique<Bishop>(Point2D{ side + 2 * step, startY }, isWhite, isTop));
+            }
+
+            pieces.push_back(std::make_unique<Queen>(Point2D{ 3, startY }, isWhite, isTop));
+            pieces.push_back(std::make_unique<King>(Point2D{ 4, startY }, isWhite, isTop));
+
+            std::fill(std::begin(squares), std::end(squares), nullptr);
+            for (auto& piece : pieces)
+                squares[MakeSquare(piece->GetPos().x, piece->GetPos().y)] = piece.get();
+        }
+
+        inline std::vector<std::unique_ptr<Character>>& GetPieces()
+        {
+            return pieces;
+        }
+    };
+}
+
+
+namespace
+{
+    // keeps the compiler from dropping the work being timed
+    volatile uint64_t sink;
+
+    template<typename Work>
+    double nsPerRound(int rounds, Work work)
+    {
+        uint64_t sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+            sum += work();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        sink = sum;
+        return seconds * 1e9 / rounds;
+    }
+
+    void report(const char* test, double before, double now)
+    {
+        std::cout << std::left << std::setw(8) << test << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << before << std::setw(12) << now
+            << std::setw(10) << std::setprecision(2) << (now > 0 ? before / now : 0) << std::endl;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    int rounds = 200000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--rounds") && i + 1 < argc) rounds = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            std::cerr << "usage: chess_piece_bench [--rounds n]" << std::endl;
+            return 2;
+        }
+    }
+
+    Attacks::Init();
+    initPlayers();
+
+    Legacy::Player legacy[2];
+    legacy[WHITE].Reset(true, false);
+    legacy[BLACK].Reset(false, true);
+    Player* players[2] = { blackPlayer, whitePlayer };
+    const Position& position = CollisionBoard::GetPosition();
+    int side = position.GetSideToMove();
+
+    // both must find the same moves, or the timings say nothing
+    uint64_t legacyMoves = 0;
+    for (auto& piece : legacy[side].GetPieces())
+        legacyMoves += piece->GetPath().Size();
+    MoveList pseudo;
+    generatePseudoLegal(position, pseudo);
+    if (legacyMoves != pseudo.Size())
+    {
+        std::cerr << "the old classes find " << legacyMoves << " moves, movegen " << pseudo.Size() << std::endl;
+        return 1;
+    }
+
+    std::cout << rounds << " rounds, ns per round" << std::endl
+        << std::left << std::setw(8) << "test" << std::right << std::setw(12) << "Character"
+        << std::setw(12) << "PieceSet" << std::setw(10) << "x" << std::endl;
+
+    double before = nsPerRound(rounds, [&]() {
+        legacy[WHITE].Reset(true, false);
+        legacy[BLACK].Reset(false, true);
+        return legacy[WHITE].GetPieces().size();
+        });
+    double now = nsPerRound(rounds, [&]() {
+        whitePlayer->Reset(true, false);
+        blackPlayer->Reset(false, true);
+        return static_cast<size_t>(whitePlayer->GetPieces().count);
+        });
+    report("setup", before, now);
+
+    before = nsPerRound(rounds, [&]() {
+        uint64_t sum = 0;
+        for (auto& player : legacy)
+            for (auto& piece : player.GetPieces())
+                if (piece->IsActive())
+                    sum += MakeSquare(piece->GetPos().x, piece->GetPos().y) + static_cast<int>(piece->GetName()) + piece->GetColor();
+        return sum;
+        });
+    now = nsPerRound(rounds, [&]() {
+        uint64_t sum = 0;
+        for (auto player : players)
+        {
+            const PieceSet& pieces = player->GetPieces();
+            for (int slot = 0; slot < pieces.count; slot++)
+                if (pieces.IsActive(slot))
+                    sum += pieces.squares[slot] + static_cast<int>(pieces.names[slot]) + pieces.colors[slot];
+        }
+        return sum;
+        });
+    report("scan", before, now);
+
+    before = nsPerRound(rounds, [&]() {
+        uint64_t count = 0;
+        for (auto& piece : legacy[side].GetPieces())
+            count += piece->GetPath().Size();
+        return count;
+        });
+    now = nsPerRound(rounds, [&]() {
+        MoveList moves;
+        generatePseudoLegal(position, moves);
+        return static_cast<uint64_t>(moves.Size());
+        });
+    report("moves", before, now);
+
+    return 0;
+}
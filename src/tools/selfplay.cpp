@@ -0,0 +1,406 @@
+/*****************************************************************//**
+ * \file   selfplay.cpp
+ * \brief  Headless self-play, many games at once on every core
+ *
+ *  chess_selfplay [--games n] [--threads n] [--chooser random|greedy|search]
+ *                 [--depth n] [--nodes n] [--opening n] [--max-plies n]
+ *                 [--seed n] [--out games.cgl]
+ *
+ * Every game is played by the same chooser for both sides. The games are
+ * shared out as one range of game numbers per thread, a thread that runs
+ * out steals the upper half of the largest range left. A game is played
+ * from its own seed, so the same seed gives the same games whatever the
+ * number of threads, only their order in the log changes. Each finished
+ * game is appended to the log (see gamelog.hpp), an empty --out plays
+ * without writing.
+ *
+ * A game ends on mate, stalemate, the fifty move rule, a repetition, too
+ * little material to mate or after --max-plies, which is left unfinished.
+ *********************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <random>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include "position.hpp"
+#include "movegen.hpp"
+#include "search.hpp"
+#include "gamelog.hpp"
+
+
+/**
+ * Picks the move to play among the legal ones, which are never empty.
+ * One per thread, so it may keep state between the moves of a game, which
+ * newGame, if set, drops before every game.
+ */
+struct MoveChooser
+{
+    std::function<Move(const Position&, const MoveList&, std::mt19937_64&)> choose;
+    std::function<void()> newGame;
+};
+
+
+struct SelfPlayOptions
+{
+    int games = 1000;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string chooser = "random";
+    // for the search chooser, a node limit of 0 for none
+    int depth = 4;
+    uint64_t nodes = 0;
+    // plies played at random before the chooser takes over, so a chooser
+    // that always picks the same move still plays different games
+    int opening = 8;
+    int maxPlies = 400;
+    uint64_t seed = 1;
+    std::string out = "selfplay.cgl";
+};
+
+
+// a cache line each, the threads update theirs after every game
+struct alignas(64) SelfPlayStats
+{
+    uint64_t games = 0;
+    uint64_t plies = 0;
+    uint64_t results[4] = { 0, 0, 0, 0 };
+};
+
+
+/**
+ * Game numbers [0, count) split into one range per thread. A thread takes
+ * from the bottom of its own range, a thread whose range is empty moves
+ * the top of the largest other range down to take its upper half. A range
+ * is one atomic word, so neither side takes a lock.
+ */
+class GameRanges
+{
+public:
+    GameRanges(int count, int threads) : ranges(threads)
+    {
+        for (int t = 0; t < threads; t++)
+            ranges[t].word.store(pack(count * static_cast<int64_t>(t) / threads, count * static_cast<int64_t>(t + 1) / threads));
+    }
+
+    /**
+     * The next game for the thread, false when every game has been taken.
+     */
+    bool Next(int thread, int& game)
+    {
+        while (true)
+        {
+            uint64_t range = ranges[thread].word.load();
+            while (low(range) < high(range))
+            {
+                if (ranges[thread].word.compare_exchange_weak(range, pack(low(range) + 1, high(range))))
+                {
+                    game = low(range);
+                    return true;
+                }
+            }
+
+            if (!Steal(thread))
+                return false;
+        }
+    }
+
+private:
+    // a cache line each, a thread taking a game does not slow the others down
+    struct alignas(64) Range
+    {
+        std::atomic<uint64_t> word;
+    };
+
+    std::vector<Range> ranges;
+
+    static uint64_t pack(int64_t low, int64_t high)
+    {
+        return static_cast<uint64_t>(low) | (static_cast<uint64_t>(high) << 32);
+    }
+
+    static int low(uint64_t range)
+    {
+        return static_cast<int>(range & 0xFFFFFFFF);
+    }
+
+    static int high(uint64_t range)
+    {
+        return static_cast<int>(range >> 32);
+    }
+
+    bool Steal(int thread)
+    {
+        while (true)
+        {
+            int victim = -1, most = 0;
+            uint64_t seen = 0;
+            for (int t = 0; t < static_cast<int>(ranges.size()); t++)
+            {
+                uint64_t range = ranges[t].word.load();
+                if (t != thread && high(range) - low(range) > most)
+                {
+                    victim = t;
+                    most = high(range) - low(range);
+                    seen = range;
+                }
+            }
+            if (victim < 0)
+                return false;
+
+            // the upper half, the last game of a range too
+            int middle = low(seen) + most / 2;
+            if (ranges[victim].word.compare_exchange_strong(seen, pack(low(seen), middle)))
+            {
+                ranges[thread].word.store(pack(middle, high(seen)));
+                return true;
+            }
+        }
+    }
+};
+
+
+// the points of the piece a move takes plus what a promotion gains
+int materialGain(const Position& position, Move m)
+{
+    int gain = 0;
+    if (m.Flags() == Move::EN_PASSANT)
+        gain += PIECE_POINTS[static_cast<int>(CharacterName::PAWN)];
+    else if (m.IsCapture())
+        gain += PIECE_POINTS[static_cast<int>(position.GetNameAt(m.To()))];
+
+    if (m.IsPromotion())
+        gain += PIECE_POINTS[static_cast<int>(m.GetPromotion())] - PIECE_POINTS[static_cast<int>(CharacterName::PAWN)];
+
+    return gain;
+}
+
+
+Move randomMove(const MoveList& moves, std::mt19937_64& rng)
+{
+    return moves[rng() % moves.Size()];
+}
+
+
+MoveChooser makeChooser(const SelfPlayOptions& options)
+{
+    if (options.chooser == "random")
+        return { [](const Position&, const MoveList& moves, std::mt19937_64& rng) { return randomMove(moves, rng); }, nullptr };
+
+    // the largest material gain this move, a random one among equals
+    if (options.chooser == "greedy")
+        return { [](const Position& position, const MoveList& moves, std::mt19937_64& rng) {
+            MoveList best;
+            int bestGain = -1;
+            for (Move m : moves)
+            {
+                int gain = materialGain(position, m);
+                if (gain > bestGain)
+                {
+                    best.Clear();
+                    bestGain = gain;
+                }
+                if (gain == bestGain)
+                    best.Add(m);
+            }
+            return randomMove(best, rng);
+        }, nullptr };
+
+    if (options.chooser == "search")
+    {
+        // a table and search of the thread's own, both emptied for every game
+        // so that a game depends on its seed alone
+        auto table = std::make_shared<TranspositionTable>(1);
+        auto search = std::make_shared<Search>(*table);
+        Search::Limits limits;
+        limits.depth = options.depth;
+        limits.nodes = options.nodes;
+
+        return {
+            [table, search, limits](const Position& position, const MoveList& moves, std::mt19937_64& rng) {
+                table->NewSearch();
+                Move best = search->Run(position, limits).BestMove();
+                return best ? best : randomMove(moves, rng);
+            },
+            [table, search]() {
+                table->Clear();
+                search->Clear();
+            } };
+    }
+
+    return {};
+}
+
+
+// kings and at most one knight or bishop between both sides
+bool insufficientMaterial(const Position& position)
+{
+    if (position.GetPieces(CharacterName::PAWN) | position.GetPieces(CharacterName::ROOK) | position.GetPieces(CharacterName::QUEEN))
+        return false;
+
+    return PopCount(position.GetPieces(CharacterName::KNIGHT) | position.GetPieces(CharacterName::BISHOP)) <= 1;
+}
+
+
+/**
+ * Plays a game from the start position, leaving its moves and the key
+ * after each one in the vectors.
+ */
+GameResult playGame(const SelfPlayOptions& options, const MoveChooser& chooser, uint64_t seed,
+    std::vector<Move>& moves, std::vector<uint64_t>& keys)
+{
+    if (chooser.newGame)
+        chooser.newGame();
+
+    std::mt19937_64 rng(seed);
+    Position position;
+    position.SetStartPosition();
+    moves.clear();
+    keys.clear();
+
+    MoveList legal;
+    for (int ply = 0; ply < options.maxPlies; ply++)
+    {
+        legal.Clear();
+        generateLegal(position, legal);
+
+        if (legal.Empty())
+        {
+            if (!position.InCheck())
+                return GameResult::DRAW;
+            return position.GetSideToMove() == WHITE ? GameResult::BLACK_WINS : GameResult::WHITE_WINS;
+        }
+        if (position.GetHalfmoveClock() >= 100 || position.IsRepetition() || insufficientMaterial(position))
+            return GameResult::DRAW;
+
+        Move m = ply < options.opening ? randomMove(legal, rng) : chooser.choose(position, legal, rng);
+        position.MakeMove(m);
+        moves.push_back(m);
+        keys.push_back(position.GetKey());
+    }
+
+    return GameResult::UNKNOWN;
+}
+
+
+SelfPlayStats selfPlay(const SelfPlayOptions& options, GameLogWriter* log)
+{
+    GameRanges ranges(options.games, options.threads);
+    std::vector<SelfPlayStats> results(options.threads);
+    std::mutex logMutex;
+
+    Position start;
+    start.SetStartPosition();
+
+    auto work = [&](int thread) {
+        SelfPlayStats& stats = results[thread];
+        MoveChooser chooser = makeChooser(options);
+        std::vector<Move> moves;
+        std::vector<uint64_t> keys;
+        moves.reserve(options.maxPlies);
+        keys.reserve(options.maxPlies);
+
+        for (int game; ranges.Next(thread, game);)
+        {
+            GameResult result = playGame(options, chooser, options.seed * 0x9E3779B97F4A7C15ull + game, moves, keys);
+            stats.games++;
+            stats.plies += moves.size();
+            stats.results[static_cast<int>(result)]++;
+
+            if (!log)
+                continue;
+
+            // a whole game at once, the writer buffers it
+            std::lock_guard<std::mutex> lock(logMutex);
+            log->BeginGame(start);
+            for (size_t i = 0; i < moves.size(); i++)
+                log->AddMove(moves[i], keys[i]);
+            log->EndGame(result);
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (int t = 1; t < options.threads; t++)
+        helpers.emplace_back(work, t);
+    work(0);
+    for (auto& helper : helpers)
+        helper.join();
+
+    SelfPlayStats total;
+    for (const auto& stats : results)
+    {
+        total.games += stats.games;
+        total.plies += stats.plies;
+        for (int r = 0; r < 4; r++)
+            total.results[r] += stats.results[r];
+    }
+    return total;
+}
+
+
+int main(int argc, char* argv[])
+{
+    SelfPlayOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--games" && hasValue) options.games = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--threads" && hasValue) options.threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--chooser" && hasValue) options.chooser = argv[++i];
+        else if (arg == "--depth" && hasValue) options.depth = std::clamp(std::atoi(argv[++i]), 1, Search::MAX_PLY - 1);
+        else if (arg == "--nodes" && hasValue) options.nodes = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--opening" && hasValue) options.opening = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--max-plies" && hasValue) options.maxPlies = std::clamp(std::atoi(argv[++i]), 1, Position::MAX_HISTORY - 1);
+        else if (arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--out" && hasValue) options.out = argv[++i];
+        else
+        {
+            std::cerr << "usage: chess_selfplay [--games n] [--threads n] [--chooser random|greedy|search]" << std::endl
+                << "                      [--depth n] [--nodes n] [--opening n] [--max-plies n]" << std::endl
+                << "                      [--seed n] [--out games.cgl]" << std::endl;
+            return 2;
+        }
+    }
+
+    if (!makeChooser(options).choose)
+    {
+        std::cerr << "unknown chooser " << options.chooser << std::endl;
+        return 2;
+    }
+
+    Attacks::Init();
+
+    GameLogWriter log;
+    if (!options.out.empty() && !log.Open(options.out.c_str()))
+    {
+        std::cerr << "cannot write " << options.out << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    SelfPlayStats stats = selfPlay(options, log.IsOpen() ? &log : nullptr);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    log.Close();
+
+    std::cout << stats.games << " games, " << stats.plies << " positions, " << options.threads << " threads, "
+        << options.chooser << " chooser" << std::endl
+        << "  1-0 " << stats.results[static_cast<int>(GameResult::WHITE_WINS)]
+        << "  0-1 " << stats.results[static_cast<int>(GameResult::BLACK_WINS)]
+        << "  1/2-1/2 " << stats.results[static_cast<int>(GameResult::DRAW)]
+        << "  * " << stats.results[static_cast<int>(GameResult::UNKNOWN)] << std::endl
+        << std::fixed << std::setprecision(3) << "Time: " << seconds << "s"
+        << std::setprecision(0) << "  Games/s: " << (seconds > 0 ? stats.games / seconds : 0)
+        << "  Positions/s: " << (seconds > 0 ? stats.plies / seconds : 0) << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+/*****************************************************************//**
+ * \file   attacks_test.cpp
+ * \brief  Attack tables against the square by square walks they replaced
+ *
+ * The reference functions below are the GetPath() walks of the old
+ * Character classes, written against a pair of bitboards instead of the
+ * collision board. Every square is checked on random boards, for both
+ * colors. The pawn's two-step push is left out, the tables only hold the
+ * single step (the double push is a movegen rule).
+ *********************************************************************/
+
+#include <iostream>
+#include <random>
+
+#include "attacks.hpp"
+
+
+namespace
+{
+    struct Board
+    {
+        Bitboard own, enemy;
+
+        // -1 empty, 0 own, 1 enemy
+        int At(int x, int y) const
+        {
+            int sq = MakeSquare(x, y);
+            return TestBit(own, sq) ? 0 : TestBit(enemy, sq) ? 1 : -1;
+        }
+    };
+
+    bool onBoard(int x, int y)
+    {
+        return x >= 0 && x < 8 && y >= 0 && y < 8;
+    }
+
+    // the squares reached by stepping once along each offset
+    Bitboard stepPath(const Board& board, int sq, const int (*offsets)[2], int count)
+    {
+        Bitboard path = 0;
+        for (int i = 0; i < count; i++)
+        {
+            int x = SquareX(sq) + offsets[i][0], y = SquareY(sq) + offsets[i][1];
+            if (onBoard(x, y) && board.At(x, y) != 0)
+                path |= SquareBB(MakeSquare(x, y));
+        }
+        return path;
+    }
+
+    // the squares reached by walking each direction until a piece, taking an enemy one
+    Bitboard rayPath(const Board& board, int sq, const int (*directions)[2])
+    {
+        Bitboard path = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            int x = SquareX(sq) + directions[i][0], y = SquareY(sq) + directions[i][1];
+            for (; onBoard(x, y); x += directions[i][0], y += directions[i][1])
+            {
+                int at = board.At(x, y);
+                if (at != 0)
+                    path |= SquareBB(MakeSquare(x, y));
+                if (at >= 0)
+                    break;
+            }
+        }
+        return path;
+    }
+
+    // black starts on row 0 and moves down the rows, white the other way
+    Bitboard pawnPath(const Board& board, int sq, int color)
+    {
+        Bitboard path = 0;
+        int x = SquareX(sq), y = SquareY(sq) + (color == BLACK ? 1 : -1);
+        if (!onBoard(x, y))
+            return 0;
+
+        if (board.At(x, y) < 0)
+            path |= SquareBB(MakeSquare(x, y));
+        for (int dx : { -1, 1 })
+            if (onBoard(x + dx, y) && board.At(x + dx, y) == 1)
+                path |= SquareBB(MakeSquare(x + dx, y));
+        return path;
+    }
+
+    const int KNIGHT_STEPS[8][2] = { { 2, 1 }, { 2, -1 }, { -2, 1 }, { -2, -1 }, { 1, 2 }, { -1, 2 }, { 1, -2 }, { -1, -2 } };
+    const int KING_STEPS[8][2] = { { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 }, { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+    const int ROOK_RAYS[4][2] = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+    const int BISHOP_RAYS[4][2] = { { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 } };
+}
+
+
+int main()
+{
+    Attacks::Init();
+
+    std::mt19937_64 rng(2025);
+    long checks = 0, failures = 0;
+
+    auto expect = [&](const char* piece, int sq, Bitboard got, Bitboard want) {
+        checks++;
+        if (got != want && failures++ < 10)
+            std::cerr << piece << " on square " << sq << ": got " << std::hex << got << " expected " << want << std::dec << std::endl;
+    };
+
+    for (int board = 0; board < 2000; board++)
+    {
+        // sparse to crowded boards, the piece's own square is always free
+        Bitboard occupied = rng() & rng() & (board % 2 ? rng() : ~Bitboard(0));
+        Bitboard ownMask = rng();
+
+        for (int sq = 0; sq < SQUARE_NB; sq++)
+        {
+            Bitboard blockers = occupied & ~SquareBB(sq);
+            Board b{ blockers & ownMask, blockers & ~ownMask };
+            Bitboard notOwn = ~b.own;
+
+            expect("knight", sq, Attacks::Knight(sq) & notOwn, stepPath(b, sq, KNIGHT_STEPS, 8));
+            expect("king", sq, Attacks::King(sq) & notOwn, stepPath(b, sq, KING_STEPS, 8));
+            expect("rook", sq, Attacks::Rook(sq, blockers) & notOwn, rayPath(b, sq, ROOK_RAYS));
+            expect("bishop", sq, Attacks::Bishop(sq, blockers) & notOwn, rayPath(b, sq, BISHOP_RAYS));
+            expect("queen", sq, Attacks::Queen(sq, blockers) & notOwn, rayPath(b, sq, ROOK_RAYS) | rayPath(b, sq, BISHOP_RAYS));
+
+            for (int color : { BLACK, WHITE })
+                expect("pawn", sq, (Attacks::Pawn(color, sq) & b.enemy) | (Attacks::PAWN_PUSH[color][sq] & ~blockers), pawnPath(b, sq, color));
+        }
+    }
+
+    std::cout << checks << " checks, " << failures << " failed" << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+/*****************************************************************//**
+ * \file   gamelog_test.cpp
+ * \brief  PGN dates through the binary game log and back
+ *
+ * Games dated before 1970, after 2106 and not dated at all go from PGN
+ * to a log and back to PGN, and must keep their Date tag and moves. A
+ * version 1 log, written by hand, must still read back with its dates.
+ *********************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "gamelog.hpp"
+
+
+namespace
+{
+    const char* PGN_PATH = "gamelog_test.pgn";
+    const char* LOG_PATH = "gamelog_test.cgl";
+    const char* OLD_LOG_PATH = "gamelog_test_v1.cgl";
+
+    const char* DATES[] = { "1851.06.21", "1969.12.31", "1970.01.01", "2025.04.08", "2150.01.01", "????.??.??" };
+
+    // the Date tags in the order they are in the text
+    std::vector<std::string> dateTags(const std::string& pgn)
+    {
+        std::vector<std::string> dates;
+        for (size_t at = pgn.find("[Date \""); at != std::string::npos; at = pgn.find("[Date \"", at + 1))
+            dates.push_back(pgn.substr(at + 7, 10));
+        return dates;
+    }
+
+    void writeWord(std::ofstream& out, uint16_t word)
+    {
+        out.put(static_cast<char>(word & 0xFF));
+        out.put(static_cast<char>(word >> 8));
+    }
+
+    int failures = 0;
+
+    void expect(bool ok, const std::string& what)
+    {
+        if (!ok)
+        {
+            std::cerr << "FAIL  " << what << std::endl;
+            failures++;
+        }
+    }
+}
+
+
+int main()
+{
+    Attacks::Init();
+    std::remove(LOG_PATH);
+
+    {
+        std::ofstream pgn(PGN_PATH);
+        for (const char* date : DATES)
+            pgn << "[Event \"?\"]\n[Date \"" << date << "\"]\n[Result \"1-0\"]\n\n1. e4 e5 2. f4 exf4 1-0\n\n";
+    }
+
+    expect(pgnToGameLog(PGN_PATH, LOG_PATH) == static_cast<long long>(std::size(DATES)), "every game converted");
+
+    std::ostringstream out;
+    expect(gameLogToPgn(LOG_PATH, out) == static_cast<long long>(std::size(DATES)), "every game read back");
+
+    auto dates = dateTags(out.str());
+    expect(dates.size() == std::size(DATES), "one Date tag per game");
+    for (size_t i = 0; i < dates.size() && i < std::size(DATES); i++)
+        expect(dates[i] == DATES[i], std::string("date ") + DATES[i] + " came back as " + dates[i]);
+    expect(out.str().find("1. e4 e5 2. f4 exf4 1-0") != std::string::npos, "moves read back");
+
+    // version 1: 2 unsigned words of time, 0 when not known
+    {
+        std::ofstream log(OLD_LOG_PATH, std::ios::binary);
+        log.write(GameLog::MAGIC, sizeof(GameLog::MAGIC));
+        writeWord(log, 1);
+        writeWord(log, GameLog::DEFAULT_CHECKPOINT_INTERVAL);
+        for (uint32_t time : { 0u, 1700000000u })
+        {
+            writeWord(log, GameLog::MarkerWord(GameLog::GAME_BEGIN));
+            writeWord(log, static_cast<uint16_t>(time));
+            writeWord(log, static_cast<uint16_t>(time >> 16));
+            writeWord(log, Move(MakeSquare(4, 6), MakeSquare(4, 4), Move::DOUBLE_PUSH).Raw());
+            writeWord(log, GameLog::MarkerWord(GameLog::GAME_END, static_cast<int>(GameResult::DRAW)));
+        }
+    }
+
+    std::ostringstream old;
+    expect(gameLogToPgn(OLD_LOG_PATH, old) == 2, "version 1 games read back");
+    dates = dateTags(old.str());
+    expect(dates == std::vector<std::string>{ "????.??.??", "2023.11.14" }, "version 1 dates");
+    expect(old.str().find("1. e4 1/2-1/2") != std::string::npos, "version 1 moves");
+
+    GameLogWriter writer;
+    expect(!writer.Open(OLD_LOG_PATH), "a version 1 log is not appended to");
+
+    std::remove(PGN_PATH);
+    std::remove(LOG_PATH);
+    std::remove(OLD_LOG_PATH);
+
+    std::cout << (failures ? "FAIL" : "ok") << std::endl;
+    return failures ? 1 : 0;
+}
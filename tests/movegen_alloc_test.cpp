@@ -0,0 +1,106 @@
+/*****************************************************************//**
+ * \file   movegen_alloc_test.cpp
+ * \brief  Move generation must not touch the heap
+ *
+ * The global operator new is replaced by one that counts while a walk is
+ * running. Each walk generates every kind of move list and plays and takes
+ * back every legal move down to a small depth, on the perft reference
+ * positions, and must end with nothing allocated.
+ *********************************************************************/
+
+#include <iostream>
+#include <cstdlib>
+#include <new>
+
+#include "position.hpp"
+#include "movegen.hpp"
+
+
+namespace
+{
+    bool counting = false;
+    long allocations = 0;
+}
+
+
+void* operator new(std::size_t size)
+{
+    if (counting)
+        allocations++;
+
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+namespace
+{
+    const char* POSITIONS[] = {
+        Position::START_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+    };
+
+    long walk(Position& position, int depth)
+    {
+        MoveList pseudo, captures, legalCaptures, legal;
+        generatePseudoLegal(position, pseudo);
+        generateCaptures(position, captures);
+        generateLegalCaptures(position, legalCaptures);
+        generateLegal(position, legal);
+
+        long nodes = 1;
+        if (depth == 0)
+            return nodes;
+
+        for (Move m : legal)
+        {
+            position.MakeMove(m);
+            position.InCheck();
+            nodes += walk(position, depth - 1);
+            position.UnmakeMove();
+        }
+        return nodes;
+    }
+}
+
+
+int main()
+{
+    Attacks::Init();
+
+    int failed = 0;
+    for (const char* fen : POSITIONS)
+    {
+        Position position;
+        if (!position.SetFen(fen))
+        {
+            std::cerr << "bad fen " << fen << std::endl;
+            return 1;
+        }
+
+        allocations = 0;
+        counting = true;
+        long nodes = walk(position, 3);
+        counting = false;
+
+        std::cout << (allocations ? "FAIL  " : "ok    ") << nodes << " nodes, " << allocations << " allocations  " << fen << std::endl;
+        failed += allocations != 0;
+    }
+
+    return failed ? 1 : 0;
+}